@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# bad option values must end with the usage error, before any input is read
+
+DATAFILE=${1:-"../../data/Chemical_340"}
+CMD="../gspan -i $DATAFILE -o /dev/null -l -s 0.5"
+
+status=0
+
+function expect_usage
+{
+    timeout 10 $CMD "$@" >/dev/null 2>&1
+    local rc=$?
+    if [ $rc -ne 1 ]; then
+	echo "FAIL: $* exits with $rc, expected 1"
+	status=1
+    fi
+}
+
+expect_usage -t -1
+expect_usage -t 0
+expect_usage -t 4x
+expect_usage -t ''
+expect_usage -t 4294967297
+
+timeout 10 $CMD -t 2 >/dev/null 2>&1 || { echo "FAIL: -t 2"; status=1; }
+
+[ $status -eq 0 ] && echo "OK"
+exit $status
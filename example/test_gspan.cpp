@@ -7,22 +7,30 @@
  */
 
 #include "gspan.hpp"
+#include "gspan_graph_db.hpp"
+#include "gspan_label_dict.hpp"
+#include "gspan_output_writer.hpp"
 
-#include <boost/graph/adjacency_list.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
-#include <list>
+#include <string_view>
 #include <vector>
-#include <map>
-#include <set>
+#include <unordered_map>
 #include <algorithm>
-#include <functional>
+#include <memory>
+#include <charconv>
+#include <chrono>
+#include <thread>
 
-#include <cctype>
 #include <cstdlib>
+#include <cstring>
 
 using namespace boost;
 
@@ -41,11 +49,20 @@ print_usage(std::ostream& s)
       "       in this case --minsupp=NUM option is used, as more useful.\n"
       "Options:\n"
       "  -i, --input FILE        file to read, default stdin\n"
+      "  -b, --db FILE           mine binary graph database FILE instead of input\n"
+      "  -m, --make-db FILE      write input to binary graph database FILE and exit\n"
       "  -o, --output FILE       file to write, default stdout\n"
       "  -c, --mincount NUM      minimal count, integer value, default 1\n"
       "  -s, --minsupp NUM       minimal support, 0..1\n"
       "  -l, --legacy            use tgf format for input and output (slower!)\n"
       "  -e, --embeddings [opts] none, autgrp, all. default is none\n"
+      "  -t, --threads NUM       number of loading and mining threads, default 1,\n"
+      "                            at most 4 per hardware thread\n"
+      "  -r, --relabel           relabel input by descending label frequency;\n"
+      "                            output still shows the original labels;\n"
+      "                            with --make-db, the database is relabeled\n"
+      "  -d, --shrink            remove edges of each mined first edge branch\n"
+      "                            from the input of the later branches\n"
       "  -h, --help              this help"
       << std::endl;
 }
@@ -56,12 +73,12 @@ void error_usage()
     exit(1);
 }
 
-std::ifstream input_fstream;
+std::string input_file;
 std::ofstream output_fstream;
-std::istream* input_stream = &std::cin;
 std::ostream* output_stream = &std::cout;
 bool no_output = false;
 bool use_legacy = false;
+bool use_relabel = false;
 enum OutputMappings {
     OUTPUT_MAPPING_NONE,
     OUTPUT_MAPPING_ONE_AUTOMORPH,
@@ -72,102 +89,126 @@ static std::size_t pattern_no = 0;
 
 /**
  * Vertex and edge properties are used by algorithm.
- * To optimize comparison, they are integers (not strings)
- *
- * vertex values are addressed by boost::vertex_name
- * edge values   are addressed by boost::edge_name
+ * To optimize comparison, they are integers (not strings):
+ * values of egf input are interned, legacy input has integer values
+ */
+gspan::label_dict v_values;
+gspan::label_dict e_values;
+
+/**
+ * Original labels, if input is relabeled (--relabel)
  */
-std::vector<std::string> v_values;
-std::vector<std::string> e_values;
+gspan::label_table<std::size_t, std::size_t> labels;
 
 std::size_t
-map_string_to_integer(std::vector<std::string>& values,
-                      const std::string& value)
+original_vertex_label(std::size_t l)
 {
-    auto valit = std::find(values.begin(), values.end(), value);
-    if (valit == values.end()) {
-        valit = values.insert(values.end(), value);
-    }
-    return valit - values.begin();
+    return use_relabel ? labels.vertex_label(l) : l;
+}
+
+std::size_t
+original_edge_label(std::size_t l)
+{
+    return use_relabel ? labels.edge_label(l) : l;
 }
 
-using VP = property<vertex_name_t, std::size_t>;
-using EP =
-    property<edge_index_t, std::size_t, property<edge_name_t, std::size_t> >;
+/**
+ * Input graphs are mined as read-only copies in CSR form,
+ * labels are bundled properties, graph bundle is the graph id
+ */
+using MiningGraph = gspan::csr_graph<std::size_t, std::size_t, std::size_t>;
+
+using GspanTraits = gspan_traits<MiningGraph, vertex_bundle_t, edge_bundle_t>;
+using OneGraphSG = gspan_traits<MiningGraph, vertex_bundle_t, edge_bundle_t,
+      gspan::one_graph_tag>::SG;
+using ManyGraphsSG = gspan_traits<MiningGraph, vertex_bundle_t, edge_bundle_t,
+      gspan::many_graphs_tag>::SG;
 
-using InputGraph = adjacency_list<vecS, vecS, undirectedS, VP, EP, std::size_t>;
-using InputGraphVertex = graph_traits<InputGraph>::vertex_descriptor;
-using InputGraphEdge = graph_traits<InputGraph>::edge_descriptor;
-using GspanTraits = gspan_traits<InputGraph, vertex_name_t, edge_name_t>;
+/**
+ * Ids of the input graphs, as read, by their dense ids in input order
+ */
+std::vector<std::size_t> input_graph_ids;
+
+/**
+ * Patterns are formatted on the mining thread and written by this one,
+ * null if there is no output
+ */
+std::unique_ptr<gspan::output_writer> pattern_writer;
 
 template <typename MG, typename SBG>
 void
-print_mapping(const MG& mg,
+print_mapping(gspan::text_buffer& os,
+              const MG& mg,
               const SBG& s,
               std::size_t map_no,
               std::size_t autmorph_no)
 {
-    std::ostream& os = *output_stream;
-
-    os << std::endl;
-    os << "m " << map_no << " # automorh " << autmorph_no << std::endl;
-    const InputGraph& ig = *s.input_graph();
+    os << '\n';
+    os << "m " << map_no << " # automorh " << autmorph_no << '\n';
+    const MiningGraph& ig = *s.input_graph();
     for (auto v_mg : vertices(mg)) {
         auto v_ig = get_v_ig(s, v_mg);
         os << "v " << v_index(mg, v_mg) << " ";
         os << ig[graph_bundle] << " ";
-        os << get(get(vertex_index, ig), v_ig) << std::endl;
+        os << get(get(vertex_index, ig), v_ig) << '\n';
     }
     for (auto e_mg : edges(mg)) {
         auto e_ig = get_e_ig(s, e_mg);
         os << "e " << e_index(mg, e_mg) << " ";
         os << ig[graph_bundle] << " ";
-        os << get(get(edge_index, ig), e_ig) << std::endl;
+        os << get(get(edge_index, ig), e_ig) << '\n';
     }
 }
 
+template <typename SG>
 void
-write_egf(const GspanTraits::MG& mg, const GspanTraits::SG& sg, int support)
+write_egf(const GspanTraits::MG& mg, const SG& sg, int support,
+          const gspan::graph_set&)
 {
     ++pattern_no;
 
     if (no_output)
         return;
 
-    std::ostream& os = *output_stream;
+    gspan::text_buffer os(pattern_writer->buffer());
 
-    os << std::endl;
-    os << "p " << pattern_no << " # occurence " << support << std::endl;
+    os << '\n';
+    os << "p " << pattern_no << " # occurence " << support << '\n';
     for (auto v : vertices(mg))
-        os << "v " << v_index(mg, v) << " " << v_values[v_bundle(mg, v)]
-           << std::endl;
+        os << "v " << v_index(mg, v) << " "
+           << v_values.name(original_vertex_label(v_bundle(mg, v))) << '\n';
     for (auto e : edges(mg))
         os << "e " << e_index(mg, e) << " " << source_index(mg, e) << " "
-           << target_index(mg, e) << " " << e_values[e_bundle(mg, e)] << std::endl;
+           << target_index(mg, e) << " "
+           << e_values.name(original_edge_label(e_bundle(mg, e))) << '\n';
 
     if (output_mappings != OUTPUT_MAPPING_NONE) {
         std::size_t map_no = 0;
         for (const auto& g_sbgs : sg) {
-            for (const auto& grp : g_sbgs.second.aut_list) {
+            for (const auto& grp : g_sbgs.second.aut_groups()) {
                 std::size_t autmorph_no = 0;
                 for (const auto& s : grp) {
-                    print_mapping(mg, *s, ++map_no, ++autmorph_no);
+                    print_mapping(os, mg, *s, ++map_no, ++autmorph_no);
                     if (output_mappings == OUTPUT_MAPPING_ONE_AUTOMORPH)
                         break;
                 }
             }
         }
     }
+
+    pattern_writer->commit();
 }
 
+template <typename SG>
 void
-write_tgf(const GspanTraits::MG& mg, const GspanTraits::SG& sg, int support)
+write_tgf(const GspanTraits::MG& mg, const SG&, int support,
+          const gspan::graph_set& graphs)
 {
     ++pattern_no;
 
     if (no_output)
         return;
-    std::ostream& os = *output_stream;
+    gspan::text_buffer os(pattern_writer->buffer());
 
     using MGE = GspanTraits::MG::edge_descriptor;
     std::vector<MGE> mg_edges; // to reverse (for matching with gbolt)
@@ -176,247 +217,630 @@ write_tgf(const GspanTraits::MG& mg, const GspanTraits::SG& sg, int support)
     for (auto e : edges(mg))
         mg_edges.push_back(e);
 
-    os << "t # " << pattern_no - 1 << " * " << support << std::endl;
+    os << "t # " << pattern_no - 1 << " * " << support << '\n';
     for (auto v : vertices(mg))
-        os << "v " << v_index(mg, v) << " " << v_bundle(mg, v) << std::endl;
+        os << "v " << v_index(mg, v) << " " << original_vertex_label(v_bundle(mg,
+                v)) << '\n';
 
     using RevIt = std::vector<MGE>::const_reverse_iterator;
     for (RevIt ei = mg_edges.rbegin(); ei != mg_edges.rend(); ++ei) {
         MGE e = *ei;
         os << "e " << source_index(mg, e) << " " << target_index(mg, e)
-           << " " << e_bundle(mg, e) << std::endl;
+           << " " << original_edge_label(e_bundle(mg, e)) << '\n';
     }
 
-    std::set<std::size_t> graph_ids;
-    for (const auto& g_sbgs : sg) {
-        const InputGraph& ig = *g_sbgs.first;
-        graph_ids.insert(ig[graph_bundle]);
+    os << "x: ";
+    graphs.for_each([&os](std::size_t gid) {
+        os << input_graph_ids[gid] << " ";
+    });
+
+    os << "\n\n";
+    pattern_writer->commit();
+}
+
+/**
+ * Input graphs, as read. Labels and edges of all graphs are in flat
+ * arrays, which are reserved before parsing: graph i has the vertices
+ * vertex_labels[graphs[i].vertex_begin] .. vertex_labels[graphs[i + 1].vertex_begin - 1]
+ * and the edges of the same range of edges
+ */
+struct input_graphs {
+    struct graph {
+        std::size_t id;
+        std::size_t vertex_begin;
+        std::size_t edge_begin;
+    };
+    std::vector<graph> graphs;
+    std::vector<std::size_t> vertex_labels;
+    std::vector<MiningGraph::edge_entry> edges;
+
+    std::size_t
+    size() const
+    {
+        return graphs.size();
     }
 
-    os << "x: ";
-    for (std::size_t graph_id : graph_ids) {
-        os << graph_id << " ";
+    std::size_t
+    vertex_end(std::size_t i) const
+    {
+        return i + 1 < graphs.size() ? graphs[i + 1].vertex_begin : vertex_labels.size();
+    }
+
+    std::size_t
+    edge_end(std::size_t i) const
+    {
+        return i + 1 < graphs.size() ? graphs[i + 1].edge_begin : edges.size();
+    }
+};
+
+/**
+ * Text of the input: the mapped file, or stdin read in large blocks
+ */
+class input_text {
+public:
+    input_text() = default;
+    input_text(const input_text&) = delete;
+    input_text& operator=(const input_text&) = delete;
+
+    ~input_text()
+    {
+        if (_mapped)
+            munmap(const_cast<char*>(_data), _size);
+    }
+
+    bool
+    open(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+                _data = static_cast<const char*>(p);
+                _size = st.st_size;
+                _mapped = true;
+                close(fd);
+                return true;
+            }
+        }
+        // not a regular file, or empty
+        ok = ok && read(fd);
+        close(fd);
+        return ok;
+    }
+
+    bool
+    read(int fd)
+    {
+        const std::size_t block = 1 << 20;
+        for (;;) {
+            std::size_t n = _buffer.size();
+            _buffer.resize(n + block);
+            ssize_t got = ::read(fd, &_buffer[n], block);
+            if (got < 0)
+                return false;
+            _buffer.resize(n + got);
+            if (got == 0)
+                break;
+        }
+        _data = _buffer.data();
+        _size = _buffer.size();
+        return true;
+    }
+
+    const char*
+    begin() const
+    {
+        return _data;
+    }
+
+    const char*
+    end() const
+    {
+        return _data + _size;
+    }
+
+    std::size_t
+    size() const
+    {
+        return _size;
     }
 
-    os << std::endl << std::endl;
+private:
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+    bool _mapped = false;
+    std::string _buffer;
+};
+
+inline bool
+is_blank(char c)
+{
+    return c == ' ' || c == '\t';
 }
 
-inline
-std::string&
-remove_comment(std::string& s)
+inline bool
+is_space(char c)
 {
-    s.erase(std::find(s.begin(), s.end(), '#'), s.end());
-    return s;
+    return c == ' ' || (c >= '\t' && c <= '\r');
 }
 
-inline
-std::string&
-remove_whitespaces_left(std::string& s)
+/**
+ * Fields of one line
+ */
+struct line_fields {
+    const char* p;
+    const char* end;
+
+    bool
+    empty() const
+    {
+        return p == end;
+    }
+
+    void
+    skip_spaces()
+    {
+        while (p != end && is_space(*p))
+            ++p;
+    }
+
+    /// next non space character, 0 at the end of the line
+    char
+    character()
+    {
+        skip_spaces();
+        return p != end ? *p++ : 0;
+    }
+
+    bool
+    number(std::size_t& x)
+    {
+        skip_spaces();
+        auto r = std::from_chars(p, end, x);
+        if (r.ec != std::errc())
+            return false;
+        p = r.ptr;
+        return true;
+    }
+
+    /// rest of the line, without leading blanks
+    std::string_view
+    rest()
+    {
+        while (p != end && is_blank(*p))
+            ++p;
+        return std::string_view(p, end - p);
+    }
+};
+
+/**
+ * Iterate lines of [p, end), calling parse(fields, line_no) for each one,
+ * until it returns false
+ */
+template <typename Parse>
+bool
+for_each_line(const char* p, const char* end, Parse&& parse)
 {
-    using namespace std;
-    s.erase(s.begin(), find_if(s.begin(), s.end(), not1(ptr_fun(&::isblank))));
-    return s;
+    std::size_t line_no = 0;
+    while (p != end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol)
+            eol = end;
+        ++line_no;
+        if (!parse(line_fields{p, eol}, line_no))
+            return false;
+        p = eol != end ? eol + 1 : end;
+    }
+    return true;
 }
 
-inline
-std::string&
-remove_whitespaces_right(std::string& s)
+/**
+ * Part of the input text, which starts at a 't' line, parsed by one worker.
+ * Values of egf input are interned by the chunk, and remapped on merge
+ */
+struct input_chunk {
+    const char* begin;
+    const char* end;
+
+    /// number of lines before the chunk
+    std::size_t line_base = 0;
+
+    input_graphs graphs;
+    gspan::label_dict v_values;
+    gspan::label_dict e_values;
+
+    /// message of the parse error
+    std::ostringstream error;
+};
+
+/// reserve the arrays by the numbers of 'v' and 'e' lines
+void
+reserve_input(input_graphs& container, const input_chunk& c)
 {
-    using namespace std;
-    auto rit = find_if(s.rbegin(), s.rend(), not1(ptr_fun(&::isblank)));
-    s.erase(rit.base(), s.end());
-    return s;
+    std::size_t nv = 0;
+    std::size_t ne = 0;
+    for_each_line(c.begin, c.end, [&](line_fields f, std::size_t) {
+        switch (f.character()) {
+        case 'v':
+            ++nv;
+            break;
+        case 'e':
+            ++ne;
+            break;
+        }
+        return true;
+    });
+    container.vertex_labels.reserve(nv);
+    container.edges.reserve(ne);
 }
 
-bool read_egf(std::list<InputGraph>& container, std::istream& is)
+/**
+ * Vertices of the current graph, by vertex id of the input.
+ * Small ids are kept in an array, which is cleared by a new generation
+ */
+class vertex_ids {
+public:
+    void
+    clear()
+    {
+        ++_generation;
+        _sparse.clear();
+    }
+
+    void
+    add(std::size_t id, std::size_t v)
+    {
+        if (id >= dense_limit) {
+            _sparse[id] = v;
+            return;
+        }
+        if (id >= _dense.size())
+            _dense.resize(std::max(id + 1, _dense.size() * 2));
+        _dense[id] = slot{_generation, v};
+    }
+
+    bool
+    find(std::size_t id, std::size_t& v) const
+    {
+        if (id >= dense_limit) {
+            auto it = _sparse.find(id);
+            if (it == _sparse.end())
+                return false;
+            v = it->second;
+            return true;
+        }
+        if (id >= _dense.size() || _dense[id].generation != _generation)
+            return false;
+        v = _dense[id].v;
+        return true;
+    }
+
+private:
+    static constexpr std::size_t dense_limit = 1 << 20;
+
+    struct slot {
+        std::size_t generation;
+        std::size_t v;
+    };
+
+    std::size_t _generation = 1;
+    std::vector<slot> _dense;
+    std::unordered_map<std::size_t, std::size_t> _sparse;
+};
+
+bool read_egf(input_chunk& c)
 {
-    std::map<std::size_t, InputGraphVertex> vmap;
-    std::size_t line_no = 0;
-    std::string line;
+    input_graphs& container = c.graphs;
+    reserve_input(container, c);
+    vertex_ids vmap;
 
-    while (getline(is, line)) {
-        ++line_no;
-        remove_comment(line);
-        remove_whitespaces_left(line);
-        remove_whitespaces_right(line);
-        if (line.empty())
-            continue;
-        char tag = 0;
-        std::stringstream ss(line);
-        ss >> tag;
-        switch (tag) {
+    return for_each_line(c.begin, c.end, [&](line_fields f, std::size_t line_no) {
+        line_no += c.line_base;
+        // remove comment and blanks
+        const char* comment = static_cast<const char*>(std::memchr(f.p, '#', f.end - f.p));
+        if (comment)
+            f.end = comment;
+        while (f.p != f.end && is_blank(*f.p))
+            ++f.p;
+        while (f.p != f.end && is_blank(f.end[-1]))
+            --f.end;
+        if (f.empty())
+            return true;
+
+        switch (f.character()) {
         case 't': {
             vmap.clear();
-            container.push_back(InputGraph());
             std::size_t graph_id = 0;
-            ss >> graph_id;
-            if (!ss) {
-                std::cerr << "invalid or missed <graph_id>, at line " << line_no
+            if (!f.number(graph_id)) {
+                c.error << "invalid or missed <graph_id>, at line " << line_no
                           << std::endl;
                 return false;
             }
-            container.back()[graph_bundle] = graph_id;
+            container.graphs.push_back(input_graphs::graph{graph_id,
+                                       container.vertex_labels.size(),
+                                       container.edges.size()});
         }
         break;
         case 'v': {
-            if (container.empty()) {
-                std::cerr << "invalid format: 't' tag missed" << std::endl;
+            if (container.graphs.empty()) {
+                c.error << "invalid format: 't' tag missed, at line " << line_no
+                          << std::endl;
                 return false;
             }
-            InputGraph& g = container.back();
-            InputGraphVertex v = add_vertex(g);
             std::size_t vertex_id = 0;
-            ss >> vertex_id;
-            if (!ss) {
-                std::cerr << "invalid or missed <vertex_id>, at line " << line_no
+            if (!f.number(vertex_id)) {
+                c.error << "invalid or missed <vertex_id>, at line " << line_no
                           << std::endl;
                 return false;
             }
-
-            std::string value;
-            getline(ss, value);
-            remove_whitespaces_left(value);
-            put(get(vertex_name, g), v, map_string_to_integer(v_values, value));
-            vmap[vertex_id] = v;
+            vmap.add(vertex_id, container.vertex_labels.size()
+                     - container.graphs.back().vertex_begin);
+            container.vertex_labels.push_back(c.v_values.intern(f.rest()));
         }
         break;
         case 'e': {
-            if (container.empty()) {
-                std::cerr << "invalid format: 't' tag missed" << std::endl;
+            if (container.graphs.empty()) {
+                c.error << "invalid format: 't' tag missed, at line " << line_no
+                          << std::endl;
                 return false;
             }
-            InputGraph& g = container.back();
             std::size_t edge_id = 0;
-            if (!(ss >> edge_id)) {
-                std::cerr << "invalid or missed <edge_id>, at line " << line_no
+            if (!f.number(edge_id)) {
+                c.error << "invalid or missed <edge_id>, at line " << line_no
                           << std::endl;
                 return false;
             }
             std::size_t src_id;
-            if (!(ss >> src_id) || vmap.find(src_id) == vmap.end()) {
-                std::cerr << "invalid or missed <vertex_id_1>, at line " << line_no
+            std::size_t u;
+            if (!f.number(src_id) || !vmap.find(src_id, u)) {
+                c.error << "invalid or missed <vertex_id_1>, at line " << line_no
                           << std::endl;
                 return false;
             }
             std::size_t dst_id;
-            if (!(ss >> dst_id) || vmap.find(dst_id) == vmap.end()) {
-                std::cerr << "invalid or missed <vertex_id_2>, at line " << line_no
+            std::size_t v;
+            if (!f.number(dst_id) || !vmap.find(dst_id, v)) {
+                c.error << "invalid or missed <vertex_id_2>, at line " << line_no
                           << std::endl;
                 return false;
             }
-
-            InputGraphVertex u = vmap[src_id];
-            InputGraphVertex v = vmap[dst_id];
-            InputGraphEdge e = add_edge(u, v, g).first;
-            put(get(edge_index, g), e, edge_id);
-
-            std::string value;
-            getline(ss, value);
-            remove_whitespaces_left(value);
-            put(get(edge_name, g), e, map_string_to_integer(e_values, value));
+            container.edges.push_back(MiningGraph::edge_entry{u, v, edge_id,
+                                      c.e_values.intern(f.rest())});
         }
         break;
         default:
-            std::cerr << "invalid or missed <tag>, at line " << line_no << std::endl;
+            c.error << "invalid or missed <tag>, at line " << line_no << std::endl;
             return false;
         }
-    }
-
-    return true;
+        return true;
+    });
 }
 
-bool read_tgf(std::list<InputGraph>& container, std::istream& is)
+bool read_tgf(input_chunk& c)
 {
-    std::map<std::size_t, InputGraphVertex> vmap;
-    std::size_t line_no = 0;
-    std::string line;
+    input_graphs& container = c.graphs;
+    reserve_input(container, c);
+    vertex_ids vmap;
 
-    while (getline(is, line)) {
-        ++line_no;
-        if (line.empty())
-            continue;
-        char tag = 0;
-        std::stringstream ss(line);
-        ss >> tag;
-        switch (tag) {
+    return for_each_line(c.begin, c.end, [&](line_fields f, std::size_t line_no) {
+        line_no += c.line_base;
+        if (f.empty())
+            return true;
+
+        switch (f.character()) {
         case 't': {
             vmap.clear();
-            container.push_back(InputGraph());
-            char nsign = 0;
             std::size_t graph_id = 0;
-            ss >> nsign >> graph_id;
-            if (!ss || nsign != '#') {
-                std::cerr << "invalid or missed <graph_id>, at line " << line_no
+            if (f.character() != '#' || !f.number(graph_id)) {
+                c.error << "invalid or missed <graph_id>, at line " << line_no
                           << std::endl;
                 return false;
             }
-            container.back()[graph_bundle] = graph_id;
+            container.graphs.push_back(input_graphs::graph{graph_id,
+                                       container.vertex_labels.size(),
+                                       container.edges.size()});
         }
         break;
         case 'v': {
-            if (container.empty()) {
-                std::cerr << "invalid format: 't' tag missed" << std::endl;
+            if (container.graphs.empty()) {
+                c.error << "invalid format: 't' tag missed, at line " << line_no
+                          << std::endl;
                 return false;
             }
-            InputGraph& g = container.back();
-            InputGraphVertex v = add_vertex(g);
+            std::size_t v = container.vertex_labels.size()
+                            - container.graphs.back().vertex_begin;
             std::size_t vertex_id = 0;
-            ss >> vertex_id;
-            if (!ss || vertex_id >= num_vertices(g)) {
-                std::cerr << "invalid or missed <vertex_id>, at line " << line_no
+            if (!f.number(vertex_id) || vertex_id > v) {
+                c.error << "invalid or missed <vertex_id>, at line " << line_no
                           << std::endl;
                 return false;
             }
 
             std::size_t ival;
-            if (!(ss >> ival)) {
-                std::cerr << "invalid or missed vertex value (integer), at line " << line_no
+            if (!f.number(ival)) {
+                c.error << "invalid or missed vertex value (integer), at line " << line_no
                           << std::endl;
                 return false;
             }
-            put(get(vertex_name, g), v, ival);
-            vmap[vertex_id] = v;
+            vmap.add(vertex_id, v);
+            container.vertex_labels.push_back(ival);
         }
         break;
         case 'e': {
-            if (container.empty()) {
-                std::cerr << "invalid format: 't' tag missed" << std::endl;
+            if (container.graphs.empty()) {
+                c.error << "invalid format: 't' tag missed, at line " << line_no
+                          << std::endl;
                 return false;
             }
-            InputGraph& g = container.back();
             std::size_t src_id;
-            if (!(ss >> src_id) || vmap.find(src_id) == vmap.end()) {
-                std::cerr << "invalid or missed <vertex_id_1>, at line " << line_no
+            std::size_t u;
+            if (!f.number(src_id) || !vmap.find(src_id, u)) {
+                c.error << "invalid or missed <vertex_id_1>, at line " << line_no
                           << std::endl;
                 return false;
             }
             std::size_t dst_id;
-            if (!(ss >> dst_id) || vmap.find(dst_id) == vmap.end()) {
-                std::cerr << "invalid or missed <vertex_id_2>, at line " << line_no
+            std::size_t v;
+            if (!f.number(dst_id) || !vmap.find(dst_id, v)) {
+                c.error << "invalid or missed <vertex_id_2>, at line " << line_no
                           << std::endl;
                 return false;
             }
 
-            InputGraphVertex u = vmap[src_id];
-            InputGraphVertex v = vmap[dst_id];
-            InputGraphEdge e = add_edge(u, v, g).first;
-            put(get(edge_index, g), e, num_edges(g) - 1);
-
             std::size_t ival;
-            if (!(ss >> ival)) {
-                std::cerr << "invalid or missed edge value (integer), at line " << line_no
+            if (!f.number(ival)) {
+                c.error << "invalid or missed edge value (integer), at line " << line_no
                           << std::endl;
                 return false;
             }
-            put(get(edge_name, g), e, ival);
+            std::size_t edge_id = container.edges.size() - container.graphs.back().edge_begin;
+            container.edges.push_back(MiningGraph::edge_entry{u, v, edge_id, ival});
         }
         break;
         default:
-            std::cerr << "invalid or missed <tag>, at line " << line_no << std::endl;
+            c.error << "invalid or missed <tag>, at line " << line_no << std::endl;
+            return false;
+        }
+        return true;
+    });
+}
+
+/**
+ * Split text into at most n chunks of about equal size,
+ * each chunk but the first one starts at a 't' line
+ */
+std::vector<input_chunk>
+split_input(const input_text& text, std::size_t n)
+{
+    std::vector<input_chunk> chunks;
+    const char* begin = text.begin();
+    const char* end = text.end();
+    std::size_t step = text.size() / n + 1;
+    while (begin != end) {
+        const char* p = begin + std::min<std::size_t>(step, end - begin);
+        while (p != end && !(p[-1] == '\n' && *p == 't')) {
+            p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            p = p ? p + 1 : end;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = p;
+        begin = p;
+    }
+    return chunks;
+}
+
+/**
+ * Append graphs of the chunk c at vertex vbase and edge ebase of input.
+ * Values of egf input are translated by vmap and emap
+ */
+void
+merge_input(input_graphs& input, std::size_t gbase, std::size_t vbase,
+            std::size_t ebase, const input_chunk& c,
+            const std::vector<std::size_t>& vmap, const std::vector<std::size_t>& emap)
+{
+    const input_graphs& part = c.graphs;
+    for (std::size_t i = 0; i < part.graphs.size(); ++i) {
+        input_graphs::graph g = part.graphs[i];
+        g.vertex_begin += vbase;
+        g.edge_begin += ebase;
+        input.graphs[gbase + i] = g;
+    }
+    for (std::size_t i = 0; i < part.vertex_labels.size(); ++i) {
+        std::size_t l = part.vertex_labels[i];
+        input.vertex_labels[vbase + i] = vmap.empty() ? l : vmap[l];
+    }
+    for (std::size_t i = 0; i < part.edges.size(); ++i) {
+        MiningGraph::edge_entry x = part.edges[i];
+        if (!emap.empty())
+            x.label = emap[x.label];
+        input.edges[ebase + i] = x;
+    }
+}
+
+/**
+ * Read graphs of text into input. With a pool, the text is split at 't'
+ * lines and the chunks are parsed concurrently; they are merged in order,
+ * so graph order and values of labels are the ones of one sequential read
+ */
+bool
+read_input(input_graphs& input, const input_text& text, gspan::thread_pool* pool)
+{
+    // a few chunks per worker, of at least a megabyte
+    const std::size_t min_chunk = 1 << 20;
+    std::size_t n = pool ? std::min<std::size_t>(pool->size() * 4,
+                  text.size() / min_chunk + 1) : 1;
+    std::vector<input_chunk> chunks = split_input(text, n);
+
+    auto for_each_chunk = [&](auto&& f) {
+        if (!pool) {
+            for (std::size_t i = 0; i < chunks.size(); ++i)
+                f(i);
+            return;
+        }
+        gspan::task_group tasks(*pool);
+        for (std::size_t i = 0; i < chunks.size(); ++i)
+            tasks.run([&f, i]() {
+            f(i);
+        });
+        tasks.wait();
+    };
+
+    if (chunks.size() > 1) {
+        std::vector<std::size_t> lines(chunks.size());
+        for_each_chunk([&](std::size_t i) {
+            lines[i] = std::count(chunks[i].begin, chunks[i].end, '\n');
+        });
+        for (std::size_t i = 1; i < chunks.size(); ++i)
+            chunks[i].line_base = chunks[i - 1].line_base + lines[i - 1];
+    }
+
+    std::vector<char> ok(chunks.size());
+    for_each_chunk([&](std::size_t i) {
+        ok[i] = (use_legacy ? read_tgf : read_egf)(chunks[i]);
+    });
+
+    // values are interned in order of the chunks, so a value gets the id
+    // of its first occurrence in the text
+    std::vector<std::vector<std::size_t>> vmaps(chunks.size());
+    std::vector<std::vector<std::size_t>> emaps(chunks.size());
+    std::size_t ng = 0;
+    std::size_t nv = 0;
+    std::size_t ne = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        const input_chunk& c = chunks[i];
+        if (!ok[i]) {
+            std::cerr << c.error.str();
             return false;
         }
+        for (std::size_t l = 0; l < c.v_values.size(); ++l)
+            vmaps[i].push_back(v_values.intern(c.v_values.name(l)));
+        for (std::size_t l = 0; l < c.e_values.size(); ++l)
+            emaps[i].push_back(e_values.intern(c.e_values.name(l)));
+        ng += c.graphs.graphs.size();
+        nv += c.graphs.vertex_labels.size();
+        ne += c.graphs.edges.size();
     }
 
+    input.graphs.resize(ng);
+    input.vertex_labels.resize(nv);
+    input.edges.resize(ne);
+    std::vector<std::size_t> gbase(chunks.size() + 1, 0);
+    std::vector<std::size_t> vbase(chunks.size() + 1, 0);
+    std::vector<std::size_t> ebase(chunks.size() + 1, 0);
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        gbase[i + 1] = gbase[i] + chunks[i].graphs.graphs.size();
+        vbase[i + 1] = vbase[i] + chunks[i].graphs.vertex_labels.size();
+        ebase[i + 1] = ebase[i] + chunks[i].graphs.edges.size();
+    }
+    for_each_chunk([&](std::size_t i) {
+        merge_input(input, gbase[i], vbase[i], ebase[i], chunks[i], vmaps[i], emaps[i]);
+    });
     return true;
 }
 
@@ -429,7 +853,8 @@ struct input_statistics {
     } v, e;
 };
 
-void calculate_statistics(const std::list<InputGraph>& container,
+template <typename Container>
+void calculate_statistics(const Container& container,
                           input_statistics* stat)
 {
     stat->graph_count = 0;
@@ -444,7 +869,7 @@ void calculate_statistics(const std::list<InputGraph>& container,
     }
     stat->v.max = stat->v.min = num_vertices(container.front());
     stat->e.max = stat->e.min = num_edges(container.front());
-    for (const InputGraph& g : container) {
+    for (const auto& g : container) {
         ++stat->graph_count;
         std::size_t vn = num_vertices(g);
         std::size_t en = num_edges(g);
@@ -473,6 +898,10 @@ main(int argc, char** argv)
     std::size_t mincount = 0;
     bool minsupp_exist = true;
     double minsupp = 1.0;
+    unsigned int nthreads = 1;
+    bool shrink = false;
+    std::string db_file;
+    std::string make_db_file;
 
     for (int i = 1; i < argc; ++i) {
         std::string opt(argv[i]);
@@ -481,10 +910,21 @@ main(int argc, char** argv)
             return 0;
         }
         else if (opt == "--input" || opt == "-i") {
-            if (++i >= argc || input_fstream.is_open())
+            if (++i >= argc || !input_file.empty())
+                error_usage();
+            input_file = argv[i];
+            continue;
+        }
+        else if (opt == "--db" || opt == "-b") {
+            if (++i >= argc || !db_file.empty())
+                error_usage();
+            db_file = argv[i];
+            continue;
+        }
+        else if (opt == "--make-db" || opt == "-m") {
+            if (++i >= argc || !make_db_file.empty())
                 error_usage();
-            input_fstream.open(argv[i]);
-            input_stream = &input_fstream;
+            make_db_file = argv[i];
             continue;
         }
         else if (opt == "--output" || opt == "-o") {
@@ -534,45 +974,198 @@ main(int argc, char** argv)
                 error_usage();
             continue;
         }
+        else if (opt == "--relabel" || opt == "-r") {
+            use_relabel = true;
+        }
+        else if (opt == "--shrink" || opt == "-d") {
+            shrink = true;
+        }
+        else if (opt == "--threads" || opt == "-t") {
+            if (++i >= argc)
+                error_usage();
+            // a signed count, so that "-1" is not taken as a huge number
+            const char* end = argv[i] + std::strlen(argv[i]);
+            long long n = 0;
+            auto r = std::from_chars(argv[i], end, n);
+            unsigned int max_threads =
+                4 * std::max(1u, std::thread::hardware_concurrency());
+            if (r.ec != std::errc() || r.ptr != end || n < 1 || n > max_threads) {
+                error_usage();
+            }
+            nthreads = n;
+            continue;
+        }
         else {
             error_usage();
         }
     }
 
-    std::list<InputGraph> input_graphs;
+    if (!db_file.empty() && (!input_file.empty() || !make_db_file.empty()))
+        error_usage();
+
+    std::vector<MiningGraph> mining_graphs;
+    gspan::graph_db<MiningGraph> db;
+    double input_mb = 0;
+    double input_mb_per_s = 0;
 
-    if (!(use_legacy ? read_tgf : read_egf)(input_graphs, *input_stream))
-        return 1;
+    if (db_file.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        input_text text;
+        if (!(input_file.empty() ? text.read(STDIN_FILENO) : text.open(input_file))) {
+            std::cerr << "can not read " << (input_file.empty() ? "stdin" : input_file)
+                      << std::endl;
+            return 1;
+        }
+
+        // workers of the loading, the mining starts its own ones;
+        // both are nthreads, which is checked with the options
+        std::unique_ptr<gspan::thread_pool> pool;
+        if (nthreads > 1)
+            pool.reset(new gspan::thread_pool(nthreads));
+
+        input_graphs input;
+        if (!read_input(input, text, pool.get()))
+            return 1;
+
+        if (use_relabel) {
+            labels = gspan::relabel_labels_by_frequency<std::size_t, std::size_t>(
+                         input.size(),
+            [&](std::size_t i, auto f) {
+                for (std::size_t v = input.graphs[i].vertex_begin; v < input.vertex_end(i); ++v)
+                    f(input.vertex_labels[v]);
+            },
+            [&](std::size_t i, auto f) {
+                for (std::size_t e = input.graphs[i].edge_begin; e < input.edge_end(i); ++e)
+                    f(input.edges[e].label);
+            });
+        }
+
+        mining_graphs.resize(input.size());
+        auto build = [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const input_graphs::graph& g = input.graphs[i];
+                mining_graphs[i] = MiningGraph(input.vertex_labels.data() + g.vertex_begin,
+                                               input.vertex_end(i) - g.vertex_begin,
+                                               input.edges.data() + g.edge_begin,
+                                               input.edge_end(i) - g.edge_begin, g.id);
+            }
+        };
+        if (pool) {
+            const std::size_t chunk = 1024;
+            gspan::task_group tasks(*pool);
+            for (std::size_t i = 0; i < input.size(); i += chunk)
+                tasks.run([&build, &input, i, chunk]() {
+                build(i, std::min(input.size(), i + chunk));
+            });
+            tasks.wait();
+        }
+        else {
+            build(0, input.size());
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        input_mb = text.size() / 1e6;
+        input_mb_per_s = elapsed.count() > 0 ? input_mb / elapsed.count() : 0;
+    }
+    else {
+        // graphs are views of the mapped file
+        if (!db.open(db_file)) {
+            std::cerr << db.error() << std::endl;
+            return 1;
+        }
+        const auto& db_labels = db.labels();
+        if (!db_labels.original.empty()) {
+            use_relabel = true;
+            labels = db_labels.original;
+        }
+        else if (use_relabel) {
+            std::cerr << "database is not relabeled, use --relabel with --make-db"
+                      << std::endl;
+            return 1;
+        }
+        if (!use_legacy && db_labels.vertex_names.empty()
+                && db_labels.edge_names.empty() && !db.graphs().empty()) {
+            std::cerr << "database has integer labels, use --legacy" << std::endl;
+            return 1;
+        }
+        v_values = db_labels.vertex_names;
+        e_values = db_labels.edge_names;
+        mining_graphs = db.graphs();
+    }
+
+    if (!make_db_file.empty()) {
+        gspan::graph_db_labels<std::size_t, std::size_t> db_labels;
+        db_labels.vertex_names = v_values;
+        db_labels.edge_names = e_values;
+        db_labels.original = labels;
+        if (!gspan::write_graph_db(make_db_file, mining_graphs.begin(),
+                                   mining_graphs.end(), db_labels)) {
+            std::cerr << "can not write " << make_db_file << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    input_graph_ids.reserve(mining_graphs.size());
+    for (const MiningGraph& g : mining_graphs)
+        input_graph_ids.push_back(g[graph_bundle]);
 
     input_statistics stat;
-    calculate_statistics(input_graphs, &stat);
+    calculate_statistics(mining_graphs, &stat);
 
     if (minsupp_exist) {
         mincount = stat.graph_count * minsupp;
     }
 
     std::cerr << std::endl;
-    std::cerr << "# input data statistics:\n"
-              << "# graph count          = " << stat.graph_count << std::endl
+    std::cerr << "# input data statistics:\n";
+    if (db_file.empty())
+        std::cerr << "# parsed MB, MB/s      = "
+                  << input_mb << ", " << input_mb_per_s << std::endl;
+    std::cerr << "# graph count          = " << stat.graph_count << std::endl
               << "# vertices avg,min,max = "
               << stat.v.avg << ", " << stat.v.min << ", " << stat.v.max << std::endl
               << "# edges avg,min,max    = "
               << stat.e.avg << ", " << stat.e.min << ", " << stat.e.max << std::endl
               << "# min_count            = " << mincount << std::endl << std::endl;
 
-    if (input_graphs.size() == 1)
-        gspan_one_graph(input_graphs.back(),
-                        mincount,
-                        use_legacy ? write_tgf : write_egf,
-                        vertex_name,
-                        edge_name);
+    if (!no_output)
+        pattern_writer.reset(new gspan::output_writer(*output_stream));
+
+    gspan::mining_stats mstat;
+    if (mining_graphs.size() == 1)
+        mstat = gspan_one_graph(mining_graphs.back(),
+                                mincount,
+                                use_legacy ? write_tgf<OneGraphSG> : write_egf<OneGraphSG>,
+                                vertex_bundle,
+                                edge_bundle,
+                                nthreads,
+                                shrink);
     else
-        gspan_many_graphs(input_graphs.begin(),
-                          input_graphs.end(),
-                          mincount,
-                          use_legacy ? write_tgf : write_egf,
-                          vertex_name,
-                          edge_name);
+        mstat = gspan_many_graphs(mining_graphs.begin(),
+                                  mining_graphs.end(),
+                                  mincount,
+                                  use_legacy ? write_tgf<ManyGraphsSG>
+                                  : write_egf<ManyGraphsSG>,
+                                  vertex_bundle,
+                                  edge_bundle,
+                                  nthreads,
+                                  shrink);
+
+    if (pattern_writer)
+        pattern_writer->close();
+
+    std::cerr << "# mining statistics:\n"
+              << "# subgraph_mining_count  = " << mstat.subgraph_mining_count << std::endl
+              << "# prefix_pruned_count    = " << mstat.prefix_pruned_count << std::endl
+              << "# triple_pruned_count    = " << mstat.triple_pruned_count << std::endl
+              << "# arena peak bytes, system allocations, ms = "
+              << mstat.arena_peak_bytes << ", " << mstat.arena_system_allocations
+              << ", " << mstat.arena_system_ms << std::endl
+              << "# min_cache hits, misses, collisions, inserts = "
+              << mstat.min_cache_hits << ", " << mstat.min_cache_misses << ", "
+              << mstat.min_cache_collisions << ", " << mstat.min_cache_inserts
+              << std::endl;
 
     std::cerr << std::endl;
     std::cerr << "# mined " << pattern_no << " patterns" << std::endl;
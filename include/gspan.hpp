@@ -9,23 +9,35 @@
 #define GSPAN_HPP
 
 #include "gspan_types.hpp"
+#include "gspan_arena.hpp"
+#include "gspan_csr_graph.hpp"
+#include "gspan_graph_set.hpp"
 #include "gspan_helpers.hpp"
+#include "gspan_min_cache.hpp"
 #include "gspan_minimum_check.hpp"
+#include "gspan_relabel.hpp"
+#include "gspan_thread_pool.hpp"
+#include "gspan_triple_index.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 /// gspan algorithm
 namespace gspan {
 
-struct one_graph_tag {
-
-};
-struct many_graphs_tag {
-};
-
 template <typename SG>
 unsigned int
 support(const SG& sg, one_graph_tag)
 {
-    return sg.begin()->second.aut_list_size;
+    return sg.begin()->second.aut_groups_size();
 }
 
 template <typename SG>
@@ -35,6 +47,92 @@ support(const SG& sg, many_graphs_tag)
     return sg.size();
 }
 
+/// the result takes the graphs of the pattern
+template <typename Result, typename MG, typename SG>
+void
+call_result(Result& result, const MG& mg, const SG& sg, unsigned int supp,
+            const graph_set& graphs, std::true_type)
+{
+    result(mg, sg, supp, graphs);
+}
+
+template <typename Result, typename MG, typename SG>
+void
+call_result(Result& result, const MG& mg, const SG& sg, unsigned int supp,
+            const graph_set&, std::false_type)
+{
+    result(mg, sg, supp);
+}
+
+/**
+ * Support of a candidate extension, counted before its embeddings are built
+ */
+struct ext_counter {
+    unsigned int supp = 0;
+
+    /// last counted graph or automorphism group
+    const void* last = nullptr;
+
+    /// edges of the input graph, which extend the last automorphism group
+    std::vector<std::size_t> last_edges;
+};
+
+/// distinct graphs
+template <typename IG, typename Group>
+void
+count(ext_counter& c, const IG* ig, const Group*, std::size_t, many_graphs_tag)
+{
+    if (c.last != ig) {
+        c.last = ig;
+        ++c.supp;
+    }
+}
+
+/// pairs of automorphism group and edge, distinct within a run of
+/// embeddings of the same group. It is an upper bound of the automorphism
+/// groups of the extension: extensions of different groups may cover
+/// the same edges.
+template <typename IG, typename Group>
+void
+count(ext_counter& c, const IG*, const Group* grp, std::size_t e,
+      one_graph_tag)
+{
+    if (c.last != grp) {
+        c.last = grp;
+        c.last_edges.clear();
+    }
+    if (std::find(c.last_edges.begin(), c.last_edges.end(), e)
+            == c.last_edges.end()) {
+        c.last_edges.push_back(e);
+        ++c.supp;
+    }
+}
+
+/// visit embeddings in order of the list, group is not used
+template <typename SBGS, typename F>
+void
+for_each_embedding(const SBGS& sbgs, F&& f, many_graphs_tag)
+{
+    for (const auto& s : sbgs.all_list)
+        f(s, &sbgs);
+}
+
+/// visit embeddings in order of the list, with their automorphism groups
+template <typename SBGS, typename F>
+void
+for_each_embedding(const SBGS& sbgs, F&& f, one_graph_tag)
+{
+    using SBG = typename decltype(sbgs.all_list)::value_type;
+    using Group = typename SBGS::group_type;
+    std::unordered_map<const SBG*, const Group*> groups;
+    groups.reserve(sbgs.all_list.size());
+    for (const auto& grp : sbgs.aut_groups())
+        for (const auto* s : grp)
+            groups.emplace(s, &grp);
+    for (const auto& s : sbgs.all_list)
+        f(s, groups[&s]);
+}
+
 template <typename Ext, typename VI, typename MG, typename IGEdge,
           typename SBG, typename VPT, typename EPT>
 void
@@ -78,123 +176,291 @@ add_edge(Ext& ext, IGEdge&& e, const IG* ig, VPT vpt, EPT ept)
     it->second[ig].insert(*edges(mg).first, e, &mg, ig);
 }
 
-template <typename RExt, typename MG, typename IG, typename SBGS,
-          typename VPT, typename EPT>
-void
-enumerate(RExt& r_ext,
-          const MG& mg,
-          const IG& ig,
-          const SBGS& sbgs,
-          VPT vpt,
-          EPT ept)
+/**
+ * Edge mask of the input graph: indexed by edge_index, false for edges
+ * which can not belong to any frequent pattern
+ */
+using edge_mask = std::vector<char>;
+
+/**
+ * Ranks of the edges of the input graph for shrinking: indexed by
+ * edge_index, the rank of the first edge branch which contains the edge.
+ * Edges of the earlier branches are removed from a branch: no minimal
+ * code of the branch contains them
+ */
+using edge_rank = std::vector<std::uint32_t>;
+
+/**
+ * Edges of the input graph skipped by the enumeration
+ */
+struct edge_filter {
+    const edge_mask* mask = nullptr;
+    const edge_rank* rank = nullptr;
+
+    /// rank of the branch of the pattern
+    std::uint32_t min_rank = 0;
+};
+
+template <typename IG, typename IGE>
+bool
+is_skipped(const edge_filter& f, const IG& ig, const IGE& e)
 {
-    /**
-     * R edges will be
-     * IF
-     * 1) forward edge  : src is rmpath vertex AND dst is new vertex OR
-     * 2) backward edge : src is rmost vertex AND dst is any rmpath vertex
-     * ELSE
-     * X edges
-     */
+    auto i = get(boost::edge_index_t(), ig, e);
+    return (f.mask && !(*f.mask)[i]) || (f.rank && (*f.rank)[i] < f.min_rank);
+}
 
+/**
+ * Right most path of the Mined graph, prepared once for all embeddings
+ */
+template <typename MG>
+struct rmpath_info {
     using MGV = typename boost::graph_traits<MG>::vertex_descriptor;
     using MGE = typename boost::graph_traits<MG>::edge_descriptor;
-    using IGV = typename boost::graph_traits<IG>::vertex_descriptor;
-    using IGE = typename boost::graph_traits<IG>::edge_descriptor;
+
+    explicit
+    rmpath_info(const MG& mg);
 
     // Right most path edges
     // is a map
     // Key   : vertex index
     // Value : rmpath edge
-    std::vector<MGE> vsrc_edges(num_edges(mg));
+    std::vector<MGE> vsrc_edges;
 
     // Right most path vertex mask
     // size == num_vertices(mg)
     // true: vertex on rm path; false otherwise
-    std::vector<bool> rmpath_vertex_mask(num_edges(mg), false);
+    std::vector<bool> rmpath_vertex_mask;
 
+    MGV rmost;
+};
+
+template <typename MG>
+rmpath_info<MG>::rmpath_info(const MG& mg)
+    : vsrc_edges(num_edges(mg)), rmpath_vertex_mask(num_edges(mg), false),
+      rmost(target(*rmpath_edges(mg).first, mg))
+{
     for (MGE e : rmpath_edges(mg)) {
         MGV v = source(e, mg);
         vsrc_edges[v_index(mg, v)] = e;
         rmpath_vertex_mask[v_index(mg, v)] = true;
     }
-    MGV rmost_mg = target(*rmpath_edges(mg).first, mg);
-    rmpath_vertex_mask[v_index(mg, rmost_mg)] = true;
+    rmpath_vertex_mask[v_index(mg, rmost)] = true;
+}
+
+/**
+ * \brief
+ * Necessary conditions of minimality of the children of the Mined graph,
+ * tested on the last edge of a child before its embeddings are built.
+ *
+ * A child is not minimal if
+ * - its new edge, as a 1-edge code, is less than the first edge:
+ *   the code which starts with the new edge is less;
+ * - its new edge is backward after a backward edge to a later vertex:
+ *   the code with the two edges swapped is less.
+ */
+template <typename MG>
+struct prefix_filter {
+    using VI = typename MG::vertex_index_type;
+    using VP = typename MG::vertex_bundled_type;
+    using EP = typename MG::edge_bundled_type;
+    using code_edge = dfs_edge<VI, VP, EP>;
+
+    explicit
+    prefix_filter(const MG& mg);
+
+    bool
+    accepts(const code_edge& key) const;
+
+    code_edge first;
+    code_edge last;
+
+    /// an edge may start a code from either of its ends
+    bool undirected;
+};
+
+template <typename MG>
+prefix_filter<MG>::prefix_filter(const MG& mg)
+    : undirected(std::is_convertible<typename boost::graph_traits<MG>::directed_category,
+                 boost::undirected_tag>::value)
+{
+    // edges are visited from the last one
+    bool is_last = true;
+    for (auto e : edges(mg)) {
+        code_edge c{source_index(mg, e), target_index(mg, e),
+                    source_bundle(mg, e), e_bundle(mg, e), target_bundle(mg, e)};
+        if (is_last)
+            last = c;
+        is_last = false;
+        first = c;
+    }
+}
+
+template <typename MG>
+bool
+prefix_filter<MG>::accepts(const code_edge& key) const
+{
+    if (code_edge{0, 1, key.src_label, key.edge_label, key.dst_label} < first)
+        return false;
+    if (undirected
+            && code_edge{0, 1, key.dst_label, key.edge_label, key.src_label} < first)
+        return false;
+    if (!key.is_forward() && !last.is_forward() && key.dst < last.dst)
+        return false;
+    return true;
+}
+
+/**
+ * Out edges of u, which may be not less than (el, vl) by (edge label,
+ * target label). Graphs with label-sorted adjacency skip the less ones,
+ * see csr_graph; others return all out edges
+ */
+template <typename IG, typename IGV, typename EL, typename VL,
+          typename VPT, typename EPT>
+auto
+out_edges_not_less(const IGV& u, const IG& ig, const EL&, const VL&, VPT, EPT)
+{
+    return out_edges(u, ig);
+}
 
+/**
+ * Enumerate R edges of one embedding
+ * \param[in] visit  called as visit(src, dst, e_ig) for each extension,
+ *                    src and dst are vertex indices of the new edge in MG
+ */
+template <typename MG, typename IG, typename SBG, typename VPT, typename EPT,
+          typename Visitor>
+void
+enumerate_embedding(const MG& mg,
+                    const rmpath_info<MG>& rm,
+                    const IG& ig,
+                    const SBG& s,
+                    VPT vpt,
+                    EPT ept,
+                    const edge_filter& filter,
+                    Visitor&& visit)
+{
+    /**
+     * R edges will be
+     * IF
+     * 1) forward edge  : src is rmpath vertex AND dst is new vertex OR
+     * 2) backward edge : src is rmost vertex AND dst is any rmpath vertex
+     * ELSE
+     * X edges
+     */
+
+    using MGV = typename boost::graph_traits<MG>::vertex_descriptor;
+    using MGE = typename boost::graph_traits<MG>::edge_descriptor;
+    using IGV = typename boost::graph_traits<IG>::vertex_descriptor;
+    using IGE = typename boost::graph_traits<IG>::edge_descriptor;
+
+    const MGV rmost_mg = rm.rmost;
     const auto& vl_min = v_bundle(mg, 0);
 
-    for (const auto& s : sbgs.all_list) {
+    // reverse mappings of s, the arrays are reused by the thread
+    static thread_local subgraph_index<SBG> index;
+    subgraph_index_scope<SBG> scope(index, s);
 
-        // from right most vertex
-        IGV rmost_ig = get_v_ig(s, rmost_mg);
-        for (IGE e_ig : out_edges(rmost_ig, ig)) {
-            IGV v = target(e_ig, ig);
+    // from right most vertex
+    IGV rmost_ig = get_v_ig(s, rmost_mg);
+    for (IGE e_ig : out_edges(rmost_ig, ig)) {
+        IGV v = target(e_ig, ig);
 
-            // skip edges in MinedGraph
-            if (get_e_mg(s, e_ig) != MGE())
-                continue;
+        // skip edges in MinedGraph
+        if (index.has_edge(e_ig))
+            continue;
 
-            MGV v_mg = get_v_mg(s, v);
-            if (v_mg == MGV()) {
-                // R forward
+        if (is_skipped(filter, ig, e_ig))
+            continue;
 
-                // Partial pruning
-                if (get(vpt, ig, v) >= vl_min) {
-                    auto src = v_index(mg, rmost_mg);
-                    auto dst = v_index(mg, rmost_mg) + 1;
-                    add_edge(r_ext, src, dst, &mg, e_ig, &s, vpt, ept);
-                }
+        MGV v_mg = index.vertex(v);
+        if (v_mg == MGV()) {
+            // R forward
+
+            // Partial pruning
+            if (get(vpt, ig, v) >= vl_min) {
+                auto src = v_index(mg, rmost_mg);
+                auto dst = v_index(mg, rmost_mg) + 1;
+                visit(src, dst, e_ig);
             }
-            else if (rmpath_vertex_mask[v_index(mg, v_mg)]) {
-                // R backward
-
-                // Partial pruning
-                MGE rmpath_e_mg = vsrc_edges[v_index(mg, v_mg)];
-                IGE rmpath_e_ig = get_e_ig(s, rmpath_e_mg);
-                BOOST_ASSERT(rmpath_e_mg != MGE());
-                BOOST_ASSERT(get(ept, ig, rmpath_e_ig) == e_bundle(mg, rmpath_e_mg));
-                BOOST_ASSERT(get(vpt, ig, source(rmpath_e_ig, ig)) == source_bundle(mg,
-                             rmpath_e_mg));
-                BOOST_ASSERT(get(vpt, ig, target(rmpath_e_ig, ig)) == target_bundle(mg,
-                             rmpath_e_mg));
-
-                if (get(ept, ig, e_ig) > get(ept, ig, rmpath_e_ig) ||
-                        (get(ept, ig, e_ig) == get(ept, ig, rmpath_e_ig) &&
-                         get(vpt, ig, rmost_ig) >= get(vpt, ig, target(rmpath_e_ig, ig)) )) {
-
-                    auto src = v_index(mg, rmost_mg);
-                    auto dst = v_index(mg, v_mg);
-                    add_edge(r_ext, src, dst, &mg, e_ig, &s, vpt, ept);
-                }
+        }
+        else if (rm.rmpath_vertex_mask[v_index(mg, v_mg)]) {
+            // R backward
+
+            // Partial pruning
+            MGE rmpath_e_mg = rm.vsrc_edges[v_index(mg, v_mg)];
+            IGE rmpath_e_ig = get_e_ig(s, rmpath_e_mg);
+            BOOST_ASSERT(rmpath_e_mg != MGE());
+            BOOST_ASSERT(get(ept, ig, rmpath_e_ig) == e_bundle(mg, rmpath_e_mg));
+            BOOST_ASSERT(get(vpt, ig, source(rmpath_e_ig, ig)) == source_bundle(mg,
+                         rmpath_e_mg));
+            BOOST_ASSERT(get(vpt, ig, target(rmpath_e_ig, ig)) == target_bundle(mg,
+                         rmpath_e_mg));
+
+            if (get(ept, ig, e_ig) > get(ept, ig, rmpath_e_ig) ||
+                    (get(ept, ig, e_ig) == get(ept, ig, rmpath_e_ig) &&
+                     get(vpt, ig, rmost_ig) >= get(vpt, ig, target(rmpath_e_ig, ig)) )) {
+
+                auto src = v_index(mg, rmost_mg);
+                auto dst = v_index(mg, v_mg);
+                visit(src, dst, e_ig);
             }
+        }
 
-        } // for out_edges(rmost_ig)
+    } // for out_edges(rmost_ig)
 
 
-        for (MGE rmpath_e_mg : rmpath_edges(mg)) {
-            IGE rmpath_e_ig = get_e_ig(s, rmpath_e_mg);
-            IGV rmpath_v_ig = source(rmpath_e_ig, ig);
-
-            for (IGE e_ig : out_edges(rmpath_v_ig, ig)) {
-                IGV u = target(e_ig, ig);
-                // skip edges and vertices in MinedGraph
-                if (get_e_mg(s, e_ig) != MGE() || get_v_mg(s, u) != MGV())
-                    continue;
-
-                if (get(ept, ig, rmpath_e_ig) < get(ept, ig, e_ig) ||
-                        (get(ept, ig, rmpath_e_ig) == get(ept, ig, e_ig) &&
-                         get(vpt, ig, target(rmpath_e_ig, ig)) <= get(vpt, ig, u) ) ) {
-
-                    // R forward
-                    auto src = v_index(mg, source(rmpath_e_mg, mg));
-                    auto dst = v_index(mg, rmost_mg) + 1;
-                    add_edge(r_ext, src, dst, &mg, e_ig, &s, vpt, ept);
-                }
+    for (MGE rmpath_e_mg : rmpath_edges(mg)) {
+        IGE rmpath_e_ig = get_e_ig(s, rmpath_e_mg);
+        IGV rmpath_v_ig = source(rmpath_e_ig, ig);
+
+        // the pruning below passes only edges not less than the rmpath edge
+        for (IGE e_ig : out_edges_not_less(rmpath_v_ig, ig,
+                                           get(ept, ig, rmpath_e_ig),
+                                           get(vpt, ig, target(rmpath_e_ig, ig)),
+                                           vpt, ept)) {
+            IGV u = target(e_ig, ig);
+            // skip edges and vertices in MinedGraph
+            if (index.has_edge(e_ig) || index.vertex(u) != MGV())
+                continue;
+
+            if (is_skipped(filter, ig, e_ig))
+                continue;
+
+            if (get(ept, ig, rmpath_e_ig) < get(ept, ig, e_ig) ||
+                    (get(ept, ig, rmpath_e_ig) == get(ept, ig, e_ig) &&
+                     get(vpt, ig, target(rmpath_e_ig, ig)) <= get(vpt, ig, u) ) ) {
+
+                // R forward
+                auto src = v_index(mg, source(rmpath_e_mg, mg));
+                auto dst = v_index(mg, rmost_mg) + 1;
+                visit(src, dst, e_ig);
             }
         }
     }
 }
 
+template <typename RExt, typename MG, typename IG, typename SBGS,
+          typename VPT, typename EPT>
+void
+enumerate(RExt& r_ext,
+          const MG& mg,
+          const IG& ig,
+          const SBGS& sbgs,
+          VPT vpt,
+          EPT ept,
+          const edge_mask* mask = nullptr)
+{
+    rmpath_info<MG> rm(mg);
+    edge_filter filter;
+    filter.mask = mask;
+    for (const auto& s : sbgs.all_list) {
+        enumerate_embedding(mg, rm, ig, s, vpt, ept, filter,
+        [&](auto src, auto dst, const auto& e_ig) {
+            add_edge(r_ext, src, dst, &mg, e_ig, &s, vpt, ept);
+        });
+    }
+}
+
 template <typename RExt,
           typename IG,
           typename VPT, typename EPT>
@@ -206,35 +472,281 @@ enumerate_one_edges(RExt& r_ext, const IG* ig, VPT vpt, EPT ept)
             add_edge(r_ext, e, ig, vpt, ept);
 }
 
+/**
+ * \brief
+ * Counters of a run of gspan_one_graph() or gspan_many_graphs()
+ */
+struct mining_stats {
+    std::size_t subgraph_mining_count = 0;
+
+    /// extensions of embeddings rejected by prefix_filter
+    std::size_t prefix_pruned_count = 0;
+
+    /// extensions of embeddings rejected by triple_bound
+    std::size_t triple_pruned_count = 0;
+
+    /// @name arenas, counted by system_resource() for the whole process
+    ///@{
+    std::size_t arena_peak_bytes = 0;
+    std::size_t arena_system_allocations = 0;
+    double arena_system_ms = 0;
+    ///@}
+
+    /// @name min_cache
+    ///@{
+    std::size_t min_cache_hits = 0;
+    std::size_t min_cache_misses = 0;
+    std::size_t min_cache_collisions = 0;
+    std::size_t min_cache_inserts = 0;
+    ///@}
+};
+
 template <typename IG, typename Result, typename SupCalcType, typename VPTag,
           typename EPTag>
 class Alg {
 public:
-    using Traits = gspan_traits<IG, VPTag, EPTag>;
+    using Traits = gspan_traits<IG, VPTag, EPTag, SupCalcType>;
     using InputGraph = typename Traits::IG;
     using MinedGraph = typename Traits::MG;
     using SG = typename Traits::SG;
     using RExt = typename Traits::RExt;
     using XExt = typename Traits::XExt;
+    using SBG = typename Traits::SBG;
+    using SBGS = typename Traits::SBGS;
 
-    Alg(Result result, unsigned int minsup, VPTag vptag, EPTag eptag)
+    Alg(Result result, unsigned int minsup, VPTag vptag, EPTag eptag,
+        unsigned int nthreads = 1)
         : vptag_(vptag), eptag_(eptag), minsup_(minsup), result_(result),
-          subgraph_mining_count_(0)
+          nthreads_(nthreads), split_depth_(3), split_embeddings_(256),
+          split_graphs_(64), shrink_(false), subgraph_mining_count_(0),
+          prefix_pruned_count_(0), triple_pruned_count_(0), pool_(nullptr)
     {
     }
 
     void
     run(const RExt& r_ext);
 
+    /// parent is the minimality state of the pattern extended by mg,
+    /// null for a pattern of one edge
+    void
+    subgraph_mining(const MinedGraph& mg, const SG& sg, unsigned int supp,
+                    const min_state<MinedGraph>* parent = nullptr);
+
+    /// Mask edges whose 1-edge pattern in r_ext is infrequent.
+    /// Valid for many graphs only: there the support of a pattern
+    /// is never greater than the support of its edges
     void
-    subgraph_mining(const MinedGraph& mg, const SG& sg, unsigned int supp);
+    mask_infrequent_edges(const RExt& r_ext);
+
+    /// Give the input graphs dense ids, in input order.
+    /// Must be called before the other preparations and run()
+    template <typename IGIter>
+    void
+    assign_graph_ids(IGIter ig_begin, IGIter ig_end)
+    {
+        graph_ids_.assign(ig_begin, ig_end);
+    }
+
+    /// Index label triples of the input graphs, to bound the support
+    /// of extensions. Valid for many graphs only
+    template <typename IGIter>
+    void
+    build_triple_index(IGIter ig_begin, IGIter ig_end);
 
     VPTag vptag_;
     EPTag eptag_;
     unsigned int minsup_;
     Result result_;
 
-    std::size_t subgraph_mining_count_;
+    /// number of workers; the first edge branches are mined concurrently
+    unsigned int nthreads_;
+
+    /// @name cutoffs for splitting a subtree into stealable tasks
+    /// a child is spawned as a task if it has at most split_depth_ edges
+    /// or at least split_embeddings_ embeddings, otherwise it is mined inline
+    ///@{
+    unsigned int split_depth_;
+    std::size_t split_embeddings_;
+    ///@}
+
+    /// a pattern with at least split_graphs_ supporting graphs
+    /// is extended by several tasks, each over its own range of graphs
+    std::size_t split_graphs_;
+
+    /// remove edges of the finished first edge branches from the later ones
+    bool shrink_;
+
+    std::atomic<std::size_t> subgraph_mining_count_;
+
+    /// extensions of embeddings rejected by prefix_filter
+    std::atomic<std::size_t> prefix_pruned_count_;
+
+    /// extensions of embeddings rejected by triple_bound
+    std::atomic<std::size_t> triple_pruned_count_;
+
+    /// minimal codes of the reported patterns
+    min_cache<MinedGraph> min_cache_;
+
+    mining_stats
+    stats() const;
+
+private:
+    using EdgeKey = dfs_edge<typename Traits::VI, typename Traits::VP,
+          typename Traits::EP>;
+
+    thread_pool* pool_;
+
+    graph_ids<InputGraph> graph_ids_;
+
+    /// by graph id; empty if all edges are enumerated
+    std::vector<edge_mask> edge_masks_;
+
+    const edge_mask*
+    mask_of(std::size_t gid) const;
+
+    /// by graph id; empty if the database is not shrunk
+    std::vector<edge_rank> edge_ranks_;
+
+    /// first edges of the branches, sorted; the rank is the position
+    std::vector<EdgeKey> first_edges_;
+
+    /// rank each edge by the earliest branch of r_ext which contains it
+    void
+    rank_edges(const RExt& r_ext);
+
+    edge_filter
+    filter_of(std::size_t gid, const EdgeKey& first) const;
+
+    using TripleIndex = triple_index<InputGraph, VPTag, EPTag>;
+    using TripleBound = triple_bound<TripleIndex>;
+
+    /// null if extensions are not bounded
+    std::unique_ptr<TripleIndex> triple_index_;
+
+    /// graphs of sg
+    graph_set
+    support_set(const SG& sg) const;
+
+    /// serializes calls of result_ from different workers
+    std::mutex result_mutex_;
+
+    /// result_ is called with the graphs of the pattern, if it takes them
+    void
+    report(const MinedGraph& mg, const SG& sg, unsigned int supp,
+           const graph_set& graphs);
+
+    void
+    mine_extensions(const RExt& r_ext, const min_state<MinedGraph>* parent);
+
+    bool
+    is_splittable(const MinedGraph& mg, const SG& sg) const;
+
+    /// extension of one embedding by one edge, before its embeddings are built
+    struct candidate {
+        /// id of the key in its extension_set
+        unsigned int key;
+        typename boost::graph_traits<InputGraph>::edge_descriptor e;
+        const InputGraph* ig;
+        const SBG* s;
+        /// graph or automorphism group of s
+        const void* grp;
+    };
+
+    /**
+     * \brief
+     * Candidates of some of the graphs, with their distinct keys.
+     * A pattern has only a few distinct extensions, so candidates keep
+     * the id of their key and are grouped by a counting sort over the ids
+     */
+    struct extension_set {
+        explicit
+        extension_set(std::pmr::memory_resource* res)
+            : keys(res), order(res), cands(res), runs(res), grouped(res)
+        {
+        }
+
+        /// distinct keys, by id
+        std::pmr::vector<EdgeKey> keys;
+
+        /// ids of the keys, sorted by key
+        std::pmr::vector<unsigned int> order;
+
+        std::pmr::vector<candidate> cands;
+
+        /// candidates of the key order[i] are grouped[runs[i]] .. grouped[runs[i + 1] - 1]
+        std::pmr::vector<std::size_t> runs;
+        std::pmr::vector<const candidate*> grouped;
+
+        unsigned int
+        key_id(const EdgeKey& key)
+        {
+            auto it = std::lower_bound(order.begin(), order.end(), key,
+            [this](unsigned int id, const EdgeKey& k) {
+                return keys[id] < k;
+            });
+            if (it != order.end() && !(key < keys[*it]))
+                return *it;
+            unsigned int id = keys.size();
+            keys.push_back(key);
+            order.insert(it, id);
+            return id;
+        }
+
+        /// fill runs and grouped, the order of candidates of a key is kept
+        void
+        group()
+        {
+            std::pmr::vector<std::size_t> rank(keys.size(), 0,
+                                               cands.get_allocator());
+            for (std::size_t i = 0; i < order.size(); ++i)
+                rank[order[i]] = i;
+            runs.assign(order.size() + 1, 0);
+            for (const candidate& c : cands)
+                ++runs[rank[c.key] + 1];
+            for (std::size_t i = 1; i < runs.size(); ++i)
+                runs[i] += runs[i - 1];
+            std::pmr::vector<std::size_t> next(runs.begin(), runs.end() - 1,
+                                               cands.get_allocator());
+            grouped.resize(cands.size());
+            for (const candidate& c : cands)
+                grouped[next[rank[c.key]]++] = &c;
+        }
+    };
+
+    /// keys with their support, sorted
+    using KeySupport = std::pmr::vector<std::pair<EdgeKey, unsigned int>>;
+
+    void
+    collect_extensions(extension_set& ext,
+                       const MinedGraph& mg,
+                       const rmpath_info<MinedGraph>& rm,
+                       const prefix_filter<MinedGraph>& filter,
+                       TripleBound* bound,
+                       const InputGraph* ig,
+                       const SBGS& sbgs);
+
+    unsigned int
+    count_support(const candidate* const* first,
+                  const candidate* const* last) const;
+
+    void
+    count_extensions(KeySupport& supp, const extension_set& ext) const;
+
+    /// build the frequent children and their embeddings;
+    /// total is the support of the keys, if it is counted elsewhere
+    void
+    materialize_extensions(RExt& r_edges,
+                           const extension_set& ext,
+                           const MinedGraph& mg,
+                           const KeySupport* total = nullptr);
+
+    void
+    enumerate_parallel(RExt& r_edges,
+                       std::vector<RExt>& parts,
+                       const MinedGraph& mg,
+                       const SG& sg,
+                       const graph_set& supp_set,
+                       std::pmr::memory_resource* res);
 };
 
 template <typename IG,
@@ -245,12 +757,115 @@ template <typename IG,
 void
 Alg<IG, Result, SupCalcType, VPTag, EPTag>::run(const RExt& r_ext)
 {
+    if (shrink_)
+        rank_edges(r_ext);
+
+    if (nthreads_ <= 1) {
+        mine_extensions(r_ext, nullptr);
+        return;
+    }
+
+    thread_pool pool(nthreads_);
+    pool_ = &pool;
+    mine_extensions(r_ext, nullptr);
+    pool_ = nullptr;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+mining_stats
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::stats() const
+{
+    mining_stats x;
+    x.subgraph_mining_count = subgraph_mining_count_;
+    x.prefix_pruned_count = prefix_pruned_count_;
+    x.triple_pruned_count = triple_pruned_count_;
+
+    const memory_stats& mem = system_resource().stats();
+    x.arena_peak_bytes = mem.peak;
+    x.arena_system_allocations = mem.allocations;
+    x.arena_system_ms = mem.nanoseconds / 1000000.0;
+
+    const min_cache_stats& cache = min_cache_.stats();
+    x.min_cache_hits = cache.hits;
+    x.min_cache_misses = cache.misses;
+    x.min_cache_collisions = cache.collisions;
+    x.min_cache_inserts = cache.inserts;
+    return x;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::report(const MinedGraph& mg,
+        const SG& sg,
+        unsigned int supp,
+        const graph_set& graphs)
+{
+    using takes_graphs = std::integral_constant<bool,
+          std::is_invocable<Result&, const MinedGraph&, const SG&, unsigned int,
+          const graph_set&>::value>;
+    if (!pool_) {
+        call_result(result_, mg, sg, supp, graphs, takes_graphs());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    call_result(result_, mg, sg, supp, graphs, takes_graphs());
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+bool
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::is_splittable(
+    const MinedGraph& mg,
+    const SG& sg) const
+{
+    if (num_edges(mg) <= split_depth_)
+        return true;
+    std::size_t n = 0;
+    for (const auto& x : sg) {
+        n += x.second.all_list.size();
+        if (n >= split_embeddings_)
+            return true;
+    }
+    return false;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::mine_extensions(
+    const RExt& r_ext,
+    const min_state<MinedGraph>* parent)
+{
+    if (!pool_) {
+        for (const auto& ext : r_ext) {
+            unsigned int supp = support(ext.second, SupCalcType());
+            if (minsup_ <= supp) {
+                subgraph_mining(ext.first, ext.second, supp, parent);
+            }
+        }
+        return;
+    }
+
+    // children are independent: each one reads only its own MG and SG
+    // and the state of the parent, and r_ext and the state are alive
+    // until all of them are finished
+    task_group children(*pool_);
     for (const auto& ext : r_ext) {
         unsigned int supp = support(ext.second, SupCalcType());
-        if (minsup_ <= supp) {
-            subgraph_mining(ext.first, ext.second, supp);
+        if (minsup_ > supp)
+            continue;
+        if (is_splittable(ext.first, ext.second)) {
+            children.run([this, &ext, supp, parent]() {
+                subgraph_mining(ext.first, ext.second, supp, parent);
+            });
+        }
+        else {
+            subgraph_mining(ext.first, ext.second, supp, parent);
         }
     }
+    children.wait();
 }
 
 template <typename IG, typename Result, typename SupCalcType, typename VPTag,
@@ -259,75 +874,429 @@ void
 Alg<IG, Result, SupCalcType, VPTag, EPTag>::subgraph_mining(
     const MinedGraph& mg,
     const SG& sg,
-    unsigned int supp)
+    unsigned int supp,
+    const min_state<MinedGraph>* parent)
 {
     ++subgraph_mining_count_;
 
-    if (!is_minimum(mg)) {
+    // the pattern is frequent: label and adjacency queries of the minimality
+    // check, of the enumeration and of the children are answered by the view
+    mg.build_flat_view();
+
+    // a code of an already reported graph is not minimal
+    if (min_cache_.lookup(mg) == min_cache<MinedGraph>::not_minimal) {
         return;
     }
 
-    result_(mg, sg, supp);
+    // embeddings of the check are kept for the checks of the children
+    min_state<MinedGraph> state(mg, parent);
+    if (!state.is_minimum()) {
+        return;
+    }
+    min_cache_.insert(mg);
 
-    RExt r_edges;
-    for (const auto& x : sg) {
-        enumerate(r_edges, mg, *x.first, x.second, vptag_, eptag_);
+    // the graphs bound the support of the children by their label triples
+    const graph_set supp_set = support_set(sg);
+    report(mg, sg, supp, supp_set);
+
+    // extensions of this level are allocated from the arena of the level
+    // and released together on return. Workers which extend a wide
+    // projection share the arena through the lock
+    const bool wide = pool_ && sg.size() >= split_graphs_;
+    std::pmr::monotonic_buffer_resource arena(arena_block_size,
+            &system_resource());
+    synchronized_resource shared(&arena);
+    std::pmr::memory_resource* res = wide ? static_cast<std::pmr::memory_resource*>
+                                     (&shared) : &arena;
+
+    // parts keep keys referenced by the embeddings merged into r_edges,
+    // so they are destroyed after r_edges
+    std::vector<RExt> parts;
+    RExt r_edges(res);
+    if (wide) {
+        enumerate_parallel(r_edges, parts, mg, sg, supp_set, res);
+    }
+    else {
+        // count support of extensions first,
+        // and build embeddings only for the frequent ones.
+        // Candidates are released before the children are mined
+        std::pmr::monotonic_buffer_resource scratch(arena_block_size,
+                &system_resource());
+        rmpath_info<MinedGraph> rm(mg);
+        prefix_filter<MinedGraph> filter(mg);
+        std::unique_ptr<TripleBound> bound;
+        if (triple_index_)
+            bound.reset(new TripleBound(*triple_index_, supp_set, minsup_));
+        extension_set ext(&scratch);
+        for (const auto& x : sg) {
+            collect_extensions(ext, mg, rm, filter, bound.get(), x.first, x.second);
+        }
+        ext.group();
+        materialize_extensions(r_edges, ext, mg);
+    }
+
+    mine_extensions(r_edges, &state);
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::collect_extensions(
+    extension_set& ext,
+    const MinedGraph& mg,
+    const rmpath_info<MinedGraph>& rm,
+    const prefix_filter<MinedGraph>& filter,
+    TripleBound* bound,
+    const InputGraph* ig,
+    const SBGS& sbgs)
+{
+    const std::size_t gid = graph_ids_.id(ig);
+    const edge_filter skip = filter_of(gid, filter.first);
+    std::size_t pruned = 0;
+    std::size_t bounded = 0;
+    for_each_embedding(sbgs, [&](const SBG& s, const auto* grp) {
+        enumerate_embedding(mg, rm, *ig, s, vptag_, eptag_, skip,
+        [&](auto src, auto dst, const auto& e_ig) {
+            if (bound && !bound->admits(gid, get(boost::edge_index_t(), *ig, e_ig))) {
+                ++bounded;
+                return;
+            }
+            EdgeKey key{src, dst,
+                        get(vptag_, *ig, source(e_ig, *ig)),
+                        get(eptag_, *ig, e_ig),
+                        get(vptag_, *ig, target(e_ig, *ig))};
+            if (!filter.accepts(key)) {
+                ++pruned;
+                return;
+            }
+            ext.cands.push_back(candidate{ext.key_id(key), e_ig, ig, &s, grp});
+        });
+    }, SupCalcType());
+    prefix_pruned_count_ += pruned;
+    triple_pruned_count_ += bounded;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+unsigned int
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::count_support(
+    const candidate* const* first,
+    const candidate* const* last) const
+{
+    ext_counter counter;
+    for (; first != last; ++first) {
+        const candidate& c = **first;
+        count(counter, c.ig, c.grp,
+              get(boost::edge_index_t(), *c.ig, c.e), SupCalcType());
+    }
+    return counter.supp;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::count_extensions(
+    KeySupport& supp,
+    const extension_set& ext) const
+{
+    const candidate* const* grouped = ext.grouped.data();
+    for (std::size_t i = 0; i < ext.order.size(); ++i) {
+        supp.emplace_back(ext.keys[ext.order[i]],
+                          count_support(grouped + ext.runs[i],
+                                        grouped + ext.runs[i + 1]));
+    }
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::materialize_extensions(
+    RExt& r_edges,
+    const extension_set& ext,
+    const MinedGraph& mg,
+    const KeySupport* total)
+{
+    const candidate* const* grouped = ext.grouped.data();
+    for (std::size_t i = 0; i < ext.order.size(); ++i) {
+        const EdgeKey& key = ext.keys[ext.order[i]];
+        const candidate* const* first = grouped + ext.runs[i];
+        const candidate* const* last = grouped + ext.runs[i + 1];
+        unsigned int supp;
+        if (total) {
+            auto it = std::lower_bound(total->begin(), total->end(), key,
+            [](const typename KeySupport::value_type& x, const EdgeKey& k) {
+                return x.first < k;
+            });
+            supp = it->second;
+        }
+        else {
+            supp = count_support(first, last);
+        }
+        if (supp < minsup_)
+            continue;
+
+        // the child pattern is built once, for its first embedding
+        const candidate& c = **first;
+        auto it = r_edges.try_emplace(make_ec(key.src, key.dst, &mg, c.e,
+                                              *c.ig, vptag_, eptag_)).first;
+        const MinedGraph* child = &it->first;
+        SG& child_sg = it->second;
+        for (; first != last; ++first) {
+            const candidate& x = **first;
+            child_sg[x.ig].insert(*edges(*child).first, x.e, child, x.s);
+        }
+    }
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::mask_infrequent_edges(
+    const RExt& r_ext)
+{
+    edge_masks_.assign(graph_ids_.size(), edge_mask());
+    for (const auto& ext : r_ext) {
+        if (support(ext.second, SupCalcType()) < minsup_)
+            continue;
+        auto e_mg = *edges(ext.first).first;
+        for (const auto& x : ext.second) {
+            edge_mask& mask = edge_masks_[graph_ids_.id(x.first)];
+            mask.resize(num_edges(*x.first), false);
+            for (const auto& s : x.second.all_list)
+                mask[get(boost::edge_index_t(), *x.first, get_e_ig(s, e_mg))] = true;
+        }
+    }
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+template <typename IGIter>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::build_triple_index(IGIter ig_begin,
+        IGIter ig_end)
+{
+    triple_index_.reset(new TripleIndex(ig_begin, ig_end, vptag_, eptag_));
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+graph_set
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::support_set(const SG& sg) const
+{
+    graph_set s(graph_ids_.size());
+    for (const auto& x : sg)
+        s.insert(graph_ids_.id(x.first));
+    return s;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+const edge_mask*
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::mask_of(std::size_t gid) const
+{
+    if (edge_masks_.empty() || edge_masks_[gid].empty())
+        return nullptr;
+    return &edge_masks_[gid];
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::rank_edges(const RExt& r_ext)
+{
+    first_edges_.clear();
+    for (const auto& ext : r_ext) {
+        auto e_mg = *edges(ext.first).first;
+        first_edges_.push_back(EdgeKey{0, 1, source_bundle(ext.first, e_mg),
+                                       e_bundle(ext.first, e_mg),
+                                       target_bundle(ext.first, e_mg)});
     }
+    std::sort(first_edges_.begin(), first_edges_.end());
 
-    for (const auto& ext : r_edges) {
-        unsigned int supp2 = support(ext.second, SupCalcType());
-        if (minsup_ <= supp2) {
-            subgraph_mining(ext.first, ext.second, supp2);
+    // an undirected edge is in the branches of both its orientations,
+    // only the earlier one may be a minimal code
+    edge_ranks_.assign(graph_ids_.size(), edge_rank());
+    for (const auto& ext : r_ext) {
+        auto e_mg = *edges(ext.first).first;
+        EdgeKey key{0, 1, source_bundle(ext.first, e_mg), e_bundle(ext.first, e_mg),
+                    target_bundle(ext.first, e_mg)};
+        std::uint32_t rank = std::lower_bound(first_edges_.begin(),
+                                              first_edges_.end(), key) - first_edges_.begin();
+        for (const auto& x : ext.second) {
+            edge_rank& ranks = edge_ranks_[graph_ids_.id(x.first)];
+            ranks.resize(num_edges(*x.first), std::uint32_t(-1));
+            for (const auto& s : x.second.all_list) {
+                auto i = get(boost::edge_index_t(), *x.first, get_e_ig(s, e_mg));
+                ranks[i] = std::min(ranks[i], rank);
+            }
         }
     }
 }
 
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+edge_filter
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::filter_of(std::size_t gid,
+        const EdgeKey& first) const
+{
+    edge_filter f;
+    f.mask = mask_of(gid);
+    if (edge_ranks_.empty() || edge_ranks_[gid].empty())
+        return f;
+    f.rank = &edge_ranks_[gid];
+    f.min_rank = std::lower_bound(first_edges_.begin(), first_edges_.end(),
+                                  first) - first_edges_.begin();
+    return f;
+}
+
+template <typename IG, typename Result, typename SupCalcType, typename VPTag,
+          typename EPTag>
+void
+Alg<IG, Result, SupCalcType, VPTag, EPTag>::enumerate_parallel(
+    RExt& r_edges,
+    std::vector<RExt>& parts,
+    const MinedGraph& mg,
+    const SG& sg,
+    const graph_set& supp_set,
+    std::pmr::memory_resource* res)
+{
+    std::vector<const typename SG::value_type*> graphs;
+    graphs.reserve(sg.size());
+    for (const auto& x : sg)
+        graphs.push_back(&x);
+
+    // a few chunks per worker, to let idle workers steal the tail
+    const std::size_t min_chunk = 16;
+    std::size_t nparts = std::min<std::size_t>(pool_->size() * 4,
+                         (graphs.size() + min_chunk - 1) / min_chunk);
+    std::size_t chunk = (graphs.size() + nparts - 1) / nparts;
+
+    // all parts share the resource of r_edges, so their nodes can be spliced.
+    // Candidates are shared by workers too, and released on return
+    std::pmr::monotonic_buffer_resource scratch(arena_block_size,
+            &system_resource());
+    synchronized_resource shared_scratch(&scratch);
+    rmpath_info<MinedGraph> rm(mg);
+    prefix_filter<MinedGraph> filter(mg);
+    std::vector<extension_set> exts;
+    std::vector<KeySupport> supps;
+    for (std::size_t i = 0; i < nparts; ++i) {
+        parts.emplace_back(res);
+        exts.emplace_back(&shared_scratch);
+        supps.emplace_back(&shared_scratch);
+    }
+
+    task_group tasks(*pool_);
+    for (std::size_t i = 0; i < nparts; ++i) {
+        tasks.run([this, &graphs, &exts, &supps, &mg, &rm, &filter, &supp_set, i,
+        chunk]() {
+            std::unique_ptr<TripleBound> bound;
+            if (triple_index_)
+                bound.reset(new TripleBound(*triple_index_, supp_set, minsup_));
+            std::size_t last = std::min(graphs.size(), (i + 1) * chunk);
+            for (std::size_t n = i * chunk; n < last; ++n) {
+                const auto& x = *graphs[n];
+                collect_extensions(exts[i], mg, rm, filter, bound.get(), x.first,
+                                   x.second);
+            }
+            exts[i].group();
+            count_extensions(supps[i], exts[i]);
+        });
+    }
+    tasks.wait();
+
+    // graphs of the chunks are disjoint, so support is the sum
+    KeySupport total(&shared_scratch);
+    for (const KeySupport& supp : supps)
+        total.insert(total.end(), supp.begin(), supp.end());
+    std::sort(total.begin(), total.end(),
+    [](const typename KeySupport::value_type& lhs,
+    const typename KeySupport::value_type& rhs) {
+        return lhs.first < rhs.first;
+    });
+    auto out = total.begin();
+    for (auto it = total.begin(); it != total.end(); ++it) {
+        if (out != total.begin() && !((out - 1)->first < it->first))
+            (out - 1)->second += it->second;
+        else
+            *out++ = *it;
+    }
+    total.erase(out, total.end());
+
+    for (std::size_t i = 0; i < nparts; ++i) {
+        tasks.run([this, &parts, &exts, &total, &mg, i]() {
+            materialize_extensions(parts[i], exts[i], mg, &total);
+        });
+    }
+    tasks.wait();
+
+    // merge in the order of chunks, so the result does not depend on
+    // scheduling. Nodes are spliced, the embeddings are not moved.
+    // Graphs of the chunks are disjoint, so SGs of equal keys merge fully.
+    for (RExt& part : parts) {
+        r_edges.merge(part);
+        for (auto& ext : part)
+            r_edges.find(ext.first)->second.merge(ext.second);
+    }
+}
+
 } // namespace gspan
 
 /**
  * Perform gSpan for one graph
+ * \return counters of the run
  */
 template <typename IG, typename Result, typename VPTag, typename EPTag>
-void
+gspan::mining_stats
 gspan_one_graph(const IG& ig,
                 unsigned int minsup,
                 Result result,
                 VPTag vptag,
-                EPTag eptag)
+                EPTag eptag,
+                unsigned int nthreads = 1,
+                bool shrink = false)
 {
-    typename gspan_traits<IG, VPTag, EPTag>::RExt r_ext;
+    typename gspan_traits<IG, VPTag, EPTag, gspan::one_graph_tag>::RExt r_ext;
     gspan::enumerate_one_edges(r_ext, &ig, vptag, eptag);
 
     using Alg = gspan::Alg<IG, Result, gspan::one_graph_tag, VPTag, EPTag>;
-    Alg alg(result, minsup, vptag, eptag);
+    Alg alg(result, minsup, vptag, eptag, nthreads);
+    alg.shrink_ = shrink;
+    alg.assign_graph_ids(&ig, &ig + 1);
     alg.run(r_ext);
+    return alg.stats();
 }
 
 /**
  * Perform gSpan for many graphs
+ * \return counters of the run
  */
 template <typename IGIter, typename Result, typename VPTag, typename EPTag>
-void
+gspan::mining_stats
 gspan_many_graphs(const IGIter ig_begin,
                   const IGIter ig_end,
                   unsigned int minsup,
                   Result result,
                   VPTag vptag,
-                  EPTag eptag)
+                  EPTag eptag,
+                  unsigned int nthreads = 1,
+                  bool shrink = false)
 {
     using IG = typename std::iterator_traits<IGIter>::value_type;
     using Alg = gspan::Alg<IG, Result, gspan::many_graphs_tag, VPTag, EPTag>;
-    Alg alg(result, minsup, vptag, eptag);
+    Alg alg(result, minsup, vptag, eptag, nthreads);
+    alg.shrink_ = shrink;
 
-    typename gspan_traits<IG, VPTag, EPTag>::RExt r_ext;
+    typename gspan_traits<IG, VPTag, EPTag, gspan::many_graphs_tag>::RExt r_ext;
     for (IGIter g = ig_begin; g != ig_end; ++g) {
         gspan::enumerate_one_edges(r_ext, &*g, vptag, eptag);
     }
 
+    alg.assign_graph_ids(ig_begin, ig_end);
+    alg.mask_infrequent_edges(r_ext);
+    alg.build_triple_index(ig_begin, ig_end);
     alg.run(r_ext);
-
-    std::cerr << "subgraph_mining_count=" << alg.subgraph_mining_count_ <<
-              std::endl;
+    return alg.stats();
 }
 
 #endif
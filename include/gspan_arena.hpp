@@ -0,0 +1,152 @@
+/**
+ * \file
+ *
+ * \brief
+ * Memory resources for the per-level arenas of the mining
+ */
+#ifndef GSPAN_ARENA_HPP
+#define GSPAN_ARENA_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Counters of the memory taken from the system by the arenas
+ */
+struct memory_stats {
+    std::atomic<std::size_t> in_use{0};
+    std::atomic<std::size_t> peak{0};
+    std::atomic<std::size_t> allocations{0};
+
+    /// time spent in the system allocator
+    std::atomic<std::uint64_t> nanoseconds{0};
+};
+
+/**
+ * \brief
+ * Thread-safe resource, which counts bytes and time of its upstream
+ */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    counting_resource(std::pmr::memory_resource* upstream, memory_stats& stats)
+        : _upstream(upstream), _stats(stats)
+    {
+    }
+
+    const memory_stats&
+    stats() const
+    {
+        return _stats;
+    }
+
+private:
+    std::pmr::memory_resource* _upstream;
+    memory_stats& _stats;
+
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void
+    do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+    bool
+    do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/**
+ * \brief
+ * Resource guarded by a mutex, to share one arena between workers
+ */
+class synchronized_resource : public std::pmr::memory_resource {
+public:
+    explicit
+    synchronized_resource(std::pmr::memory_resource* upstream)
+        : _upstream(upstream)
+    {
+    }
+
+private:
+    std::pmr::memory_resource* _upstream;
+    std::mutex _mutex;
+
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _upstream->allocate(bytes, alignment);
+    }
+
+    void
+    do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool
+    do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/// initial block of an arena, it grows geometrically
+const std::size_t arena_block_size = 4096;
+
+/// system memory, counted; thread-safe
+counting_resource&
+system_resource();
+
+// ==========================================================================
+// class counting_resource
+
+inline void*
+counting_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    auto start = std::chrono::steady_clock::now();
+    void* p = _upstream->allocate(bytes, alignment);
+    auto stop = std::chrono::steady_clock::now();
+    _stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>
+                          (stop - start).count();
+    ++_stats.allocations;
+
+    std::size_t in_use = _stats.in_use += bytes;
+    std::size_t peak = _stats.peak;
+    while (peak < in_use && !_stats.peak.compare_exchange_weak(peak, in_use))
+        ;
+    return p;
+}
+
+inline void
+counting_resource::do_deallocate(void* p, std::size_t bytes,
+                                 std::size_t alignment)
+{
+    auto start = std::chrono::steady_clock::now();
+    _upstream->deallocate(p, bytes, alignment);
+    auto stop = std::chrono::steady_clock::now();
+    _stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>
+                          (stop - start).count();
+    _stats.in_use -= bytes;
+}
+
+inline counting_resource&
+system_resource()
+{
+    static memory_stats stats;
+    static counting_resource resource(std::pmr::new_delete_resource(), stats);
+    return resource;
+}
+
+} // namespace gspan
+
+#endif
@@ -0,0 +1,815 @@
+/**
+ * \file
+ *
+ * \brief
+ * Read-only input graph in compressed sparse row form
+ */
+#ifndef GSPAN_CSR_GRAPH_HPP
+#define GSPAN_CSR_GRAPH_HPP
+
+#include <boost/graph/graph_selectors.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/pending/property.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include <boost/call_traits.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gspan {
+
+// ==========================================================================
+// class csr_graph_pmap
+
+namespace detail {
+template <typename PropertyTag, typename Graph>
+struct csr_graph_pmap_impl;
+
+template <typename Graph>
+struct csr_graph_pmap_impl<boost::vertex_index_t, Graph> {
+    typedef typename Graph::vertex_descriptor key_type;
+    typedef typename Graph::vertex_index_type value_type;
+    typedef typename Graph::vertex_index_type reference;
+    static reference
+    get_(key_type key, const Graph&)
+    {
+        return key;
+    }
+};
+
+template <typename Graph>
+struct csr_graph_pmap_impl<boost::edge_index_t, Graph> {
+    typedef typename Graph::edge_descriptor key_type;
+    typedef typename Graph::edge_index_type value_type;
+    typedef typename Graph::edge_index_type reference;
+    static reference
+    get_(const key_type& key, const Graph& g)
+    {
+        return g.edge_index(key);
+    }
+};
+
+template <typename Graph>
+struct csr_graph_pmap_impl<boost::vertex_bundle_t, Graph> {
+    typedef typename Graph::vertex_descriptor key_type;
+    typedef typename Graph::vertex_bundled_type value_type;
+    typedef typename Graph::vertex_bundled_reference reference;
+    static reference
+    get_(key_type key, const Graph& g)
+    {
+        return g.vertex_value(key);
+    }
+};
+
+template <typename Graph>
+struct csr_graph_pmap_impl<boost::edge_bundle_t, Graph> {
+    typedef typename Graph::edge_descriptor key_type;
+    typedef typename Graph::edge_bundled_type value_type;
+    typedef typename Graph::edge_bundled_reference reference;
+    static reference
+    get_(const key_type& key, const Graph& g)
+    {
+        return g.edge_value(key);
+    }
+};
+
+/// graph functions of the source graph of csr_graph, found by ADL.
+/// Members of csr_graph with the same names would hide them
+template <typename G>
+struct csr_source {
+    static auto
+    vertex_range(const G& g)
+    {
+        return vertices(g);
+    }
+
+    static auto
+    edge_range(const G& g)
+    {
+        return edges(g);
+    }
+
+    static auto
+    vertex_count(const G& g)
+    {
+        return num_vertices(g);
+    }
+
+    static auto
+    edge_count(const G& g)
+    {
+        return num_edges(g);
+    }
+
+    template <typename E>
+    static auto
+    ends(const E& e, const G& g)
+    {
+        return std::make_pair(source(e, g), target(e, g));
+    }
+};
+
+} // namespace detail
+
+template <typename PropertyTag, typename Graph>
+class csr_graph_pmap {
+    typedef detail::csr_graph_pmap_impl<PropertyTag, Graph> Impl;
+public:
+    explicit
+    csr_graph_pmap(const Graph& g)
+        : _g(&g)
+    {
+    }
+    typedef typename Impl::key_type key_type;
+    typedef typename Impl::value_type value_type;
+    typedef typename Impl::reference reference;
+    typedef boost::readable_property_map_tag category;
+    reference
+    operator[](const key_type& k) const
+    {
+        return Impl::get_(k, *_g);
+    }
+private:
+    const Graph* _g;
+};
+
+template <typename PropertyTag, typename Graph>
+typename csr_graph_pmap<PropertyTag, Graph>::reference
+get(const csr_graph_pmap<PropertyTag, Graph>& pmap,
+    const typename csr_graph_pmap<PropertyTag, Graph>::key_type& key)
+{
+    return pmap[key];
+}
+
+// ==========================================================================
+// class csr_graph
+
+struct csr_graph_tag : public boost::edge_list_graph_tag,
+    public boost::vertex_list_graph_tag,
+    public boost::incidence_graph_tag {
+};
+
+/**
+ * \brief
+ * Undirected graph in compressed sparse row form, built once and read-only.
+ *
+ * Out edges of a vertex are contiguous and sorted by (edge label,
+ * target label), so the out edges not less than a pair of labels are
+ * found by binary search, see out_edges_not_less(). Labels are bundled
+ * properties (vertex_bundle_t, edge_bundle_t). Edge index is the edge
+ * index of the source graph, it keeps the ids of the input file.
+ *
+ * The graph reads its arrays through pointers: a built graph shares
+ * them with its copies, a view reads them from memory of the caller,
+ * e.g. a mapped file, see graph_db.
+ */
+template <typename VP, typename EP, typename GP = boost::no_property,
+          typename VI = std::size_t, typename EI = std::size_t>
+class csr_graph {
+public:
+    typedef VP vertex_bundled_type;
+    typedef typename boost::call_traits<vertex_bundled_type>::param_type
+    vertex_bundled_reference;
+
+    typedef EP edge_bundled_type;
+    typedef typename boost::call_traits<edge_bundled_type>::param_type
+    edge_bundled_reference;
+
+    typedef GP graph_bundled_type;
+
+    typedef VI vertex_index_type;
+    typedef EI edge_index_type;
+
+    /// out edge entry, in sort order of the adjacency
+    struct adjacency {
+        edge_bundled_type label;
+        vertex_bundled_type target_label;
+        vertex_index_type target;
+        /// position of the edge in the edge list
+        edge_index_type edge;
+    };
+
+    /// edge list entry, in order of the source graph
+    struct edge_entry {
+        vertex_index_type src;
+        vertex_index_type dst;
+        edge_index_type index;
+        edge_bundled_type label;
+    };
+
+    /// arrays of the graph
+    struct arrays {
+        /// labels, by vertex index
+        const vertex_bundled_type* vertex_labels = nullptr;
+        std::size_t num_vertices = 0;
+
+        /// out edges of v are adj[offsets[v]] .. adj[offsets[v + 1] - 1],
+        /// num_vertices + 1 offsets
+        const std::size_t* offsets = nullptr;
+        const adjacency* adj = nullptr;
+
+        const edge_entry* edges = nullptr;
+        std::size_t num_edges = 0;
+    };
+
+    csr_graph() = default;
+
+    /**
+     * Copy graph g, labels are read by vptag and eptag
+     */
+    template <typename G, typename VPTag, typename EPTag>
+    csr_graph(const G& g, VPTag vptag, EPTag eptag,
+              const graph_bundled_type& gp = graph_bundled_type());
+
+    /**
+     * Copy num_vertices vertex labels, by vertex index, and num_edges edges,
+     * index of an edge is its edge_index
+     */
+    csr_graph(const vertex_bundled_type* vertex_labels, std::size_t num_vertices,
+              const edge_entry* edges, std::size_t num_edges,
+              const graph_bundled_type& gp = graph_bundled_type())
+        : _graph_bundle(gp)
+    {
+        auto st = std::make_shared<storage>();
+        st->vertex_labels.assign(vertex_labels, vertex_labels + num_vertices);
+        st->edges.assign(edges, edges + num_edges);
+        build(std::move(st));
+    }
+
+    /**
+     * View of arrays a, they must outlive the graph and its copies
+     */
+    csr_graph(const arrays& a, const graph_bundled_type& gp)
+        : _graph_bundle(gp), _a(a)
+    {
+    }
+
+    const arrays&
+    data() const
+    {
+        return _a;
+    }
+
+    // ------------------------------------------
+    /// @name Graph concept requirements
+    // ------------------------------------------
+    ///@{
+
+    typedef vertex_index_type vertex_descriptor;
+
+    class edge_descriptor {
+        friend class csr_graph;
+    public:
+        edge_descriptor()
+            : _src(), _dst(), _edge()
+        {
+        }
+        edge_descriptor(vertex_index_type src, vertex_index_type dst,
+                        edge_index_type edge)
+            : _src(src), _dst(dst), _edge(edge)
+        {
+        }
+        bool
+        operator==(const edge_descriptor& rhs) const
+        {
+            return _edge == rhs._edge;
+        }
+        bool
+        operator!=(const edge_descriptor& rhs) const
+        {
+            return _edge != rhs._edge;
+        }
+    private:
+        vertex_index_type _src;
+        vertex_index_type _dst;
+        edge_index_type _edge;
+    };
+
+    using directed_category = boost::undirected_tag;
+    using edge_parallel_category = boost::allow_parallel_edge_tag;
+    using traversal_category = csr_graph_tag;
+
+    static vertex_descriptor
+    null_vertex()
+    {
+        return std::numeric_limits<vertex_index_type>::max();
+    }
+
+    ///@}
+    // ------------------------------------------
+    /// @name IncidenceGraph concept requirements
+    // ------------------------------------------
+    ///@{
+
+    typedef edge_index_type degree_size_type;
+
+    class out_edge_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = edge_descriptor;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const edge_descriptor*;
+        using reference = edge_descriptor;
+
+        out_edge_iterator()
+            : _src(), _adj(nullptr)
+        {
+        }
+        out_edge_iterator(vertex_index_type src, const adjacency* adj)
+            : _src(src), _adj(adj)
+        {
+        }
+        edge_descriptor
+        operator*() const
+        {
+            return edge_descriptor(_src, _adj->target, _adj->edge);
+        }
+        out_edge_iterator&
+        operator++()
+        {
+            ++_adj;
+            return *this;
+        }
+        out_edge_iterator
+        operator++(int)
+        {
+            out_edge_iterator copy(*this);
+            ++_adj;
+            return copy;
+        }
+        bool
+        operator==(const out_edge_iterator& rhs) const
+        {
+            return _adj == rhs._adj;
+        }
+        bool
+        operator!=(const out_edge_iterator& rhs) const
+        {
+            return _adj != rhs._adj;
+        }
+    private:
+        vertex_index_type _src;
+        const adjacency* _adj;
+    };
+
+    using out_edge_iterator_pair = std::pair<out_edge_iterator, out_edge_iterator>;
+
+    out_edge_iterator_pair
+    out_edges(vertex_descriptor v) const
+    {
+        return out_edge_iterator_pair(out_edge_iterator(v, adjacency_begin(v)),
+                                      out_edge_iterator(v, adjacency_end(v)));
+    }
+
+    /// out edges of v with (edge label, target label) not less than (el, vl)
+    out_edge_iterator_pair
+    out_edges_not_less(vertex_descriptor v, edge_bundled_reference el,
+                       vertex_bundled_reference vl) const;
+
+    vertex_descriptor
+    source(const edge_descriptor& e) const
+    {
+        return e._src;
+    }
+
+    vertex_descriptor
+    target(const edge_descriptor& e) const
+    {
+        return e._dst;
+    }
+
+    degree_size_type
+    out_degree(vertex_descriptor v) const
+    {
+        return _a.offsets[v + 1] - _a.offsets[v];
+    }
+
+    const adjacency*
+    adjacency_begin(vertex_descriptor v) const
+    {
+        return _a.adj + _a.offsets[v];
+    }
+
+    const adjacency*
+    adjacency_end(vertex_descriptor v) const
+    {
+        return _a.adj + _a.offsets[v + 1];
+    }
+
+    ///@}
+    // ------------------------------------------
+    /// @name VertexListGraph concept requirements
+    // ------------------------------------------
+    ///@{
+
+    typedef vertex_index_type vertices_size_type;
+
+    class vertex_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = vertex_descriptor;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const vertex_descriptor*;
+        using reference = vertex_descriptor;
+
+        vertex_iterator(vertex_descriptor v = vertex_descriptor())
+            : _v(v)
+        {
+        }
+        vertex_descriptor
+        operator*() const
+        {
+            return _v;
+        }
+        vertex_iterator&
+        operator++()
+        {
+            ++_v;
+            return *this;
+        }
+        vertex_iterator
+        operator++(int)
+        {
+            return vertex_iterator(_v++);
+        }
+        bool
+        operator==(const vertex_iterator& rhs) const
+        {
+            return _v == rhs._v;
+        }
+        bool
+        operator!=(const vertex_iterator& rhs) const
+        {
+            return _v != rhs._v;
+        }
+    private:
+        vertex_descriptor _v;
+    };
+
+    using vertex_iterator_pair = std::pair<vertex_iterator, vertex_iterator>;
+
+    vertex_iterator_pair
+    vertices() const
+    {
+        return vertex_iterator_pair(vertex_iterator(0),
+                                    vertex_iterator(num_vertices()));
+    }
+
+    vertices_size_type
+    num_vertices() const
+    {
+        return _a.num_vertices;
+    }
+
+    ///@}
+    // ------------------------------------------
+    /// @name EdgeListGraph concept requirements
+    // ------------------------------------------
+    ///@{
+
+    typedef edge_index_type edges_size_type;
+
+    class edge_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = edge_descriptor;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const edge_descriptor*;
+        using reference = edge_descriptor;
+
+        edge_iterator(const csr_graph* g = nullptr, edge_index_type e = 0)
+            : _g(g), _e(e)
+        {
+        }
+        edge_descriptor
+        operator*() const
+        {
+            const auto& x = _g->_a.edges[_e];
+            return edge_descriptor(x.src, x.dst, _e);
+        }
+        edge_iterator&
+        operator++()
+        {
+            ++_e;
+            return *this;
+        }
+        edge_iterator
+        operator++(int)
+        {
+            return edge_iterator(_g, _e++);
+        }
+        bool
+        operator==(const edge_iterator& rhs) const
+        {
+            return _e == rhs._e;
+        }
+        bool
+        operator!=(const edge_iterator& rhs) const
+        {
+            return _e != rhs._e;
+        }
+    private:
+        const csr_graph* _g;
+        edge_index_type _e;
+    };
+
+    using edge_iterator_pair = std::pair<edge_iterator, edge_iterator>;
+
+    edge_iterator_pair
+    edges() const
+    {
+        return edge_iterator_pair(edge_iterator(this, 0),
+                                  edge_iterator(this, num_edges()));
+    }
+
+    edges_size_type
+    num_edges() const
+    {
+        return _a.num_edges;
+    }
+
+    ///@}
+    // ------------------------------------------
+    /// @name Property map concept support
+    // ------------------------------------------
+    ///@{
+
+    typedef vertex_bundled_type vertex_bundled;
+    typedef edge_bundled_type edge_bundled;
+    typedef graph_bundled_type graph_bundled;
+
+    vertex_bundled_reference
+    vertex_value(vertex_descriptor v) const
+    {
+        return _a.vertex_labels[v];
+    }
+
+    edge_index_type
+    edge_index(const edge_descriptor& e) const
+    {
+        return _a.edges[e._edge].index;
+    }
+
+    edge_bundled_reference
+    edge_value(const edge_descriptor& e) const
+    {
+        return _a.edges[e._edge].label;
+    }
+
+    const graph_bundled_type&
+    operator[](boost::graph_bundle_t) const
+    {
+        return _graph_bundle;
+    }
+
+    graph_bundled_type&
+    operator[](boost::graph_bundle_t)
+    {
+        return _graph_bundle;
+    }
+
+    ///@}
+
+private:
+    /// arrays of a built graph
+    struct storage {
+        std::vector<vertex_bundled_type> vertex_labels;
+        std::vector<std::size_t> offsets;
+        std::vector<adjacency> adj;
+        std::vector<edge_entry> edges;
+    };
+
+    graph_bundled_type _graph_bundle;
+    arrays _a;
+
+    /// null for a view
+    std::shared_ptr<const storage> _storage;
+
+    /// build the adjacency of vertex labels and edges of st, and own st
+    void
+    build(std::shared_ptr<storage> st);
+
+    static bool
+    less(const adjacency& lhs, const adjacency& rhs)
+    {
+        return std::tie(lhs.label, lhs.target_label, lhs.target)
+               < std::tie(rhs.label, rhs.target_label, rhs.target);
+    }
+};
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+template <typename G, typename VPTag, typename EPTag>
+csr_graph<VP, EP, GP, VI, EI>::csr_graph(const G& g, VPTag vptag,
+        EPTag eptag, const graph_bundled_type& gp)
+    : _graph_bundle(gp)
+{
+    using Source = detail::csr_source<G>;
+    auto vindex = get(boost::vertex_index_t(), g);
+    auto eindex = get(boost::edge_index_t(), g);
+
+    auto st = std::make_shared<storage>();
+
+    st->vertex_labels.resize(Source::vertex_count(g));
+    auto vs = Source::vertex_range(g);
+    for (auto v = vs.first; v != vs.second; ++v)
+        st->vertex_labels[get(vindex, *v)] = get(vptag, g, *v);
+
+    st->edges.reserve(Source::edge_count(g));
+    auto es = Source::edge_range(g);
+    for (auto e = es.first; e != es.second; ++e) {
+        auto uv = Source::ends(*e, g);
+        st->edges.push_back(edge_entry{vertex_index_type(get(vindex, uv.first)),
+                                       vertex_index_type(get(vindex, uv.second)),
+                                       edge_index_type(get(eindex, *e)),
+                                       get(eptag, g, *e)});
+    }
+    build(std::move(st));
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+void
+csr_graph<VP, EP, GP, VI, EI>::build(std::shared_ptr<storage> st)
+{
+    const std::vector<vertex_bundled_type>& vertex_labels = st->vertex_labels;
+    const std::vector<edge_entry>& edge_list = st->edges;
+    std::vector<std::size_t>& offsets = st->offsets;
+    std::vector<adjacency>& adj = st->adj;
+
+    offsets.assign(vertex_labels.size() + 1, 0);
+    for (const edge_entry& x : edge_list) {
+        ++offsets[x.src + 1];
+        ++offsets[x.dst + 1];
+    }
+    for (std::size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    adj.resize(offsets.back());
+    for (std::size_t i = 0; i < edge_list.size(); ++i) {
+        const edge_entry& x = edge_list[i];
+        adj[next[x.src]++] = adjacency{x.label, vertex_labels[x.dst],
+                                       x.dst, edge_index_type(i)};
+        adj[next[x.dst]++] = adjacency{x.label, vertex_labels[x.src],
+                                       x.src, edge_index_type(i)};
+    }
+    for (std::size_t v = 0; v < vertex_labels.size(); ++v)
+        std::sort(adj.begin() + offsets[v], adj.begin() + offsets[v + 1],
+                  &csr_graph::less);
+
+    _a.vertex_labels = vertex_labels.data();
+    _a.num_vertices = vertex_labels.size();
+    _a.offsets = offsets.data();
+    _a.adj = adj.data();
+    _a.edges = edge_list.data();
+    _a.num_edges = edge_list.size();
+    _storage = std::move(st);
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::out_edge_iterator_pair
+csr_graph<VP, EP, GP, VI, EI>::out_edges_not_less(vertex_descriptor v,
+        edge_bundled_reference el,
+        vertex_bundled_reference vl) const
+{
+    const adjacency* first = std::lower_bound(adjacency_begin(v),
+                             adjacency_end(v), std::make_pair(el, vl),
+    [](const adjacency& a, const std::pair<edge_bundled_type, vertex_bundled_type>& k) {
+        return std::tie(a.label, a.target_label) < std::tie(k.first, k.second);
+    });
+    return out_edge_iterator_pair(out_edge_iterator(v, first),
+                                  out_edge_iterator(v, adjacency_end(v)));
+}
+
+// ------------------------------------------
+// Graph concept requirements
+// ------------------------------------------
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::out_edge_iterator_pair
+out_edges(typename csr_graph<VP, EP, GP, VI, EI>::vertex_descriptor v,
+          const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.out_edges(v);
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::vertex_descriptor
+source(const typename csr_graph<VP, EP, GP, VI, EI>::edge_descriptor& e,
+       const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.source(e);
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::vertex_descriptor
+target(const typename csr_graph<VP, EP, GP, VI, EI>::edge_descriptor& e,
+       const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.target(e);
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::degree_size_type
+out_degree(typename csr_graph<VP, EP, GP, VI, EI>::vertex_descriptor v,
+           const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.out_degree(v);
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::vertex_iterator_pair
+vertices(const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.vertices();
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::vertices_size_type
+num_vertices(const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.num_vertices();
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::edge_iterator_pair
+edges(const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.edges();
+}
+
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::edges_size_type
+num_edges(const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return g.num_edges();
+}
+
+/**
+ * Out edges of v, which are not less than (el, vl) by (edge label,
+ * target label). Labels must be the bundled properties of the graph
+ */
+template <typename VP, typename EP, typename GP, typename VI, typename EI>
+typename csr_graph<VP, EP, GP, VI, EI>::out_edge_iterator_pair
+out_edges_not_less(typename csr_graph<VP, EP, GP, VI, EI>::vertex_descriptor v,
+                   const csr_graph<VP, EP, GP, VI, EI>& g,
+                   const EP& el,
+                   const VP& vl,
+                   boost::vertex_bundle_t,
+                   boost::edge_bundle_t)
+{
+    return g.out_edges_not_less(v, el, vl);
+}
+
+} // namespace gspan
+
+namespace boost {
+// ------------------------------------------
+// PropertyGraph requirements
+// ------------------------------------------
+template <typename VP, typename EP, typename GP, typename VI, typename EI,
+          typename PropertyTag>
+class property_map<gspan::csr_graph<VP, EP, GP, VI, EI>, PropertyTag> {
+    typedef gspan::csr_graph<VP, EP, GP, VI, EI> G;
+public:
+    typedef gspan::csr_graph_pmap<PropertyTag, G> type;
+    typedef gspan::csr_graph_pmap<PropertyTag, G> const_type;
+};
+} // namespace boost
+
+namespace gspan {
+
+//
+// get(p, g)
+//
+template <typename VP, typename EP, typename GP, typename VI, typename EI,
+          typename PropertyTag>
+typename boost::property_map<csr_graph<VP, EP, GP, VI, EI>, PropertyTag>::const_type
+get(PropertyTag, const csr_graph<VP, EP, GP, VI, EI>& g)
+{
+    return typename boost::property_map<csr_graph<VP, EP, GP, VI, EI>,
+           PropertyTag>::const_type(g);
+}
+
+//
+// get(p, g, x)
+//
+template <typename VP, typename EP, typename GP, typename VI, typename EI,
+          typename PropertyTag, typename X>
+typename boost::property_traits <
+typename boost::property_map<csr_graph<VP, EP, GP, VI, EI>, PropertyTag>::const_type >::reference
+get(PropertyTag p, const csr_graph<VP, EP, GP, VI, EI>& g, const X& x)
+{
+    return get(get(p, g), x);
+}
+
+} // namespace gspan
+
+#endif
@@ -12,6 +12,8 @@
 #include <boost/graph/properties.hpp>
 #include <boost/property_map/property_map.hpp>
 
+#include <tuple>
+
 namespace gspan {
 
 /// compare functors for R edge extentions
@@ -28,6 +30,46 @@ struct edgecode_compare_lex {
     operator()(const G& lhs, const G& rhs) const;
 };
 
+/**
+ * Last edge of a child pattern. Children of one pattern differ only
+ * by the last edge, so it is the key of the extensions of the pattern.
+ * Ordered as edgecode_compare_dfs orders the children.
+ */
+template <typename VI, typename VP, typename EP>
+struct dfs_edge {
+    VI src;
+    VI dst;
+    VP src_label;
+    EP edge_label;
+    VP dst_label;
+
+    bool
+    is_forward() const
+    {
+        return src < dst;
+    }
+};
+
+template <typename VI, typename VP, typename EP>
+bool
+operator<(const dfs_edge<VI, VP, EP>& lhs, const dfs_edge<VI, VP, EP>& rhs)
+{
+    // backward edges first, labels of their vertices are known
+    if (!lhs.is_forward()) {
+        if (rhs.is_forward())
+            return true;
+        return std::tie(lhs.dst, lhs.edge_label) < std::tie(rhs.dst, rhs.edge_label);
+    }
+    if (!rhs.is_forward())
+        return false;
+
+    // forward edges from the deepest vertex of the right most path first
+    if (lhs.src != rhs.src)
+        return lhs.src > rhs.src;
+    return std::tie(lhs.src_label, lhs.edge_label, lhs.dst_label)
+           < std::tie(rhs.src_label, rhs.edge_label, rhs.dst_label);
+}
+
 template <typename G>
 bool
 edgecode_compare_dfs::operator()(const G& g1, const G& g2) const
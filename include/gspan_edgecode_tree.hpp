@@ -17,10 +17,11 @@
 #include <boost/assert.hpp>
 
 #include <limits>
+#include <memory>
 #include <utility>
 #include <iterator>
 #include <iostream> // for debug
-#include <vector>   // for print_dfsc()
+#include <vector>
 
 namespace gspan {
 
@@ -196,6 +197,16 @@ public:
     inline const edgecodetree*
     prev_rmost() const;
 
+    /// Build the flat view of the DFS code, which answers vertex label
+    /// and first out edge queries in constant time for this code and
+    /// for the codes extending it. The code must not be shared
+    /// by other threads while the view is built
+    void
+    build_flat_view() const;
+
+    inline bool
+    has_flat_view() const;
+
     // ------------------------------------------
     /// @name Graph concept requirements
     // ------------------------------------------
@@ -426,6 +437,21 @@ private:
     const edgecodetree* _prev_src;
     const edgecodetree* _prev_dst;
 
+    /**
+     * \brief
+     * Contiguous copy of the vertices of the DFS code.
+     * Out edges of a vertex are linked by _prev_src and _prev_dst,
+     * so the last incident edge of each vertex is enough for adjacency
+     */
+    struct flat_view {
+        /// labels, by vertex index
+        std::vector<vertex_bundled_type> vertex_labels;
+        /// last edge incident to the vertex, by vertex index
+        std::vector<const edgecodetree*> last_incident;
+    };
+
+    mutable std::unique_ptr<const flat_view> _view;
+
     inline bool
     is_incident(vertex_descriptor_reference v, boost::directed_tag) const;
     inline bool
@@ -522,7 +548,7 @@ edgecodetree<VP, EP, D, VI, EI>::out_edge_iterator::out_edge_iterator(
     if (ec && ec->is_incident(v))
         _ec = ec;
     else
-        _ec = find(ec, v, directed_category());
+        _ec = ec ? ec->find_incident(v) : nullptr;
 }
 
 template <typename VP, typename EP, typename D, typename VI, typename EI>
@@ -727,7 +753,7 @@ edgecodetree<VP, EP, D, VI, EI>::edgecodetree(vertex_index_type src,
     : _src_vindex(src), _dst_vindex(dst), _eindex(0), _src_bundled(src_bundle),
       _dst_bundled(dst_bundle), _edge_bundled(edge_bundle), _prev(prev),
       _rmost(nullptr), _prev_rmost(nullptr), _prev_src(nullptr),
-      _prev_dst(nullptr)
+      _prev_dst(nullptr), _view()
 {
     _rmost = is_forward() ? this : _prev ? _prev->rmost() : nullptr;
     _eindex = prev ? prev->_eindex + 1 : 0;
@@ -753,7 +779,8 @@ edgecodetree<VP, EP, D, VI, EI>::edgecodetree(edgecodetree&& rhs)
       _dst_bundled(std::move(rhs._dst_bundled)),
       _edge_bundled(std::move(rhs._edge_bundled)), _prev(std::move(rhs._prev)),
       _rmost(std::move(rhs._rmost)), _prev_rmost(std::move(rhs._prev_rmost)),
-      _prev_src(std::move(rhs._prev_src)), _prev_dst(std::move(rhs._prev_dst))
+      _prev_src(std::move(rhs._prev_src)), _prev_dst(std::move(rhs._prev_dst)),
+      _view(std::move(rhs._view))
 {
     _rmost = is_forward() ? this : _prev ? _prev->rmost() : nullptr;
 }
@@ -786,6 +813,34 @@ edgecodetree<VP, EP, D, VI, EI>::prev_rmost() const
     return _prev_rmost;
 }
 
+template <typename VP, typename EP, typename D, typename VI, typename EI>
+void
+edgecodetree<VP, EP, D, VI, EI>::build_flat_view() const
+{
+    if (_view)
+        return;
+    std::unique_ptr<flat_view> view(new flat_view);
+    vertices_size_type nvertices = num_vertices();
+    view->vertex_labels.resize(nvertices);
+    view->last_incident.resize(nvertices, nullptr);
+    for (const edgecodetree* p = this; p; p = p->prev()) {
+        view->vertex_labels[p->_src_vindex] = p->_src_bundled;
+        view->vertex_labels[p->_dst_vindex] = p->_dst_bundled;
+        for (vertex_index_type v : {p->_src_vindex, p->_dst_vindex}) {
+            if (!view->last_incident[v] && p->is_incident(v))
+                view->last_incident[v] = p;
+        }
+    }
+    _view = std::move(view);
+}
+
+template <typename VP, typename EP, typename D, typename VI, typename EI>
+bool
+edgecodetree<VP, EP, D, VI, EI>::has_flat_view() const
+{
+    return bool(_view);
+}
+
 // ------------------------------------------
 // Graph requirements
 // ------------------------------------------
@@ -987,6 +1042,8 @@ typename edgecodetree<VP, EP, D, VI, EI>::vertex_bundled_reference
 edgecodetree<VP, EP, D, VI, EI>::vertex_value(vertex_descriptor_reference v)
 const
 {
+    if (_view && v._index < _view->vertex_labels.size())
+        return _view->vertex_labels[v._index];
     const edgecodetree* ec = find_incident(v);
     if (!ec) {
         static vertex_bundled_type nil;
@@ -1039,9 +1096,16 @@ template <typename VP, typename EP, typename D, typename VI, typename EI>
 const edgecodetree<VP, EP, D, VI, EI>*
 edgecodetree<VP, EP, D, VI, EI>::find_incident(vertex_descriptor v) const
 {
-    for (const edgecodetree* p = this; p; p = p->prev())
+    // the nearest flat view covers all the earlier edges
+    for (const edgecodetree* p = this; p; p = p->prev()) {
         if (p->is_incident(v))
             return p;
+        if (p->_view) {
+            if (v._index < p->_view->last_incident.size())
+                return p->_view->last_incident[v._index];
+            return nullptr;
+        }
+    }
     return nullptr;
 }
 
@@ -0,0 +1,415 @@
+/**
+ * \file
+ *
+ * \brief
+ * Binary database of input graphs, mined from a mapped file
+ */
+#ifndef GSPAN_GRAPH_DB_HPP
+#define GSPAN_GRAPH_DB_HPP
+
+#include "gspan_csr_graph.hpp"
+#include "gspan_label_dict.hpp"
+#include "gspan_relabel.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Labels of a graph database.
+ *
+ * Names of labels are empty if labels of the input are integers.
+ * Original labels are kept if the graphs are relabeled
+ */
+template <typename VP, typename EP>
+struct graph_db_labels {
+    label_dict vertex_names;
+    label_dict edge_names;
+    label_table<VP, EP> original;
+};
+
+namespace detail {
+
+const char graph_db_magic[8] = {'G', 'S', 'P', 'A', 'N', 'D', 'B', '\0'};
+const std::uint32_t graph_db_version = 1;
+
+/// array of count elements at offset
+struct graph_db_array {
+    std::uint64_t count;
+    std::uint64_t offset;
+};
+
+/// label_dict of count names, name i is chars[offsets[i]] .. chars[offsets[i + 1] - 1]
+struct graph_db_strings {
+    std::uint64_t count;
+    std::uint64_t offsets;
+    std::uint64_t chars;
+};
+
+struct graph_db_entry {
+    std::uint64_t num_vertices;
+    std::uint64_t num_edges;
+    std::uint64_t vertex_labels;
+    std::uint64_t offsets;
+    std::uint64_t adj;
+    std::uint64_t edges;
+};
+
+/// offsets are from the start of the file
+struct graph_db_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+
+    /// sizes of the stored types, a file of another layout is rejected
+    std::uint64_t sizes[6];
+
+    std::uint64_t file_size;
+    std::uint64_t num_graphs;
+
+    /// graph_db_entry per graph
+    std::uint64_t graphs;
+
+    /// graph bundle per graph
+    std::uint64_t bundles;
+
+    graph_db_strings vertex_names;
+    graph_db_strings edge_names;
+    graph_db_array vertex_original;
+    graph_db_array edge_original;
+};
+
+template <typename Graph>
+void
+graph_db_sizes(std::uint64_t* sizes)
+{
+    sizes[0] = sizeof(typename Graph::vertex_bundled_type);
+    sizes[1] = sizeof(typename Graph::edge_bundled_type);
+    sizes[2] = sizeof(typename Graph::graph_bundled_type);
+    sizes[3] = sizeof(std::size_t);
+    sizes[4] = sizeof(typename Graph::adjacency);
+    sizes[5] = sizeof(typename Graph::edge_entry);
+}
+
+/// sequential output, arrays start at 8-byte boundaries
+class graph_db_writer {
+public:
+    explicit
+    graph_db_writer(std::ostream& os)
+        : _os(os), _pos(0)
+    {
+    }
+
+    std::uint64_t
+    pos() const
+    {
+        return _pos;
+    }
+
+    /// \return offset of the array
+    template <typename T>
+    std::uint64_t
+    write(const T* p, std::size_t n)
+    {
+        static const char zeros[8] = {};
+        std::size_t pad = (8 - _pos % 8) % 8;
+        _os.write(zeros, pad);
+        _pos += pad;
+        std::uint64_t at = _pos;
+        _os.write(reinterpret_cast<const char*>(p), n * sizeof(T));
+        _pos += n * sizeof(T);
+        return at;
+    }
+
+    graph_db_strings
+    write(const label_dict& dict)
+    {
+        graph_db_strings x;
+        x.count = dict.size();
+        x.offsets = write(dict.offsets().data(), dict.offsets().size());
+        x.chars = write(dict.chars().data(), dict.chars().size());
+        return x;
+    }
+
+    template <typename T>
+    graph_db_array
+    write(const std::vector<T>& v)
+    {
+        graph_db_array x;
+        x.count = v.size();
+        x.offset = write(v.data(), v.size());
+        return x;
+    }
+
+private:
+    std::ostream& _os;
+    std::uint64_t _pos;
+};
+
+} // namespace detail
+
+/**
+ * Write csr_graph's [g_begin, g_end) to the database file path
+ * \return false if the file can not be written
+ */
+template <typename GraphIter, typename VP, typename EP>
+bool
+write_graph_db(const std::string& path, GraphIter g_begin, GraphIter g_end,
+               const graph_db_labels<VP, EP>& labels)
+{
+    using Graph = typename std::iterator_traits<GraphIter>::value_type;
+    using GP = typename Graph::graph_bundled_type;
+    static_assert(std::is_trivially_copyable<VP>::value
+                  && std::is_trivially_copyable<EP>::value
+                  && std::is_trivially_copyable<GP>::value,
+                  "labels and graph bundle are stored as they are in memory");
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os)
+        return false;
+
+    // the header is written again, when the offsets are known
+    detail::graph_db_header h;
+    std::memset(&h, 0, sizeof(h));
+    detail::graph_db_writer w(os);
+    w.write(&h, 1);
+
+    std::vector<detail::graph_db_entry> entries;
+    std::vector<GP> bundles;
+    for (GraphIter g = g_begin; g != g_end; ++g) {
+        const auto& a = g->data();
+        detail::graph_db_entry x;
+        x.num_vertices = a.num_vertices;
+        x.num_edges = a.num_edges;
+        x.vertex_labels = w.write(a.vertex_labels, a.num_vertices);
+        x.offsets = w.write(a.offsets, a.num_vertices + 1);
+        x.adj = w.write(a.adj, a.offsets[a.num_vertices]);
+        x.edges = w.write(a.edges, a.num_edges);
+        entries.push_back(x);
+        bundles.push_back((*g)[boost::graph_bundle]);
+    }
+
+    std::memcpy(h.magic, detail::graph_db_magic, sizeof(h.magic));
+    h.version = detail::graph_db_version;
+    detail::graph_db_sizes<Graph>(h.sizes);
+    h.num_graphs = entries.size();
+    h.graphs = w.write(entries.data(), entries.size());
+    h.bundles = w.write(bundles.data(), bundles.size());
+    h.vertex_names = w.write(labels.vertex_names);
+    h.edge_names = w.write(labels.edge_names);
+    h.vertex_original = w.write(labels.original.vertex);
+    h.edge_original = w.write(labels.original.edge);
+    h.file_size = w.pos();
+
+    os.seekp(0);
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    return bool(os.flush());
+}
+
+/**
+ * \brief
+ * Graph database mapped from a file written by write_graph_db().
+ *
+ * Arrays of the graphs are stored as they are in memory, so graphs are
+ * views of the mapping: nothing is parsed or copied, and pages are read
+ * on first use. The file is portable between builds with the same layout
+ * of the arrays only; the header keeps their sizes to reject the others.
+ * Bounds of the arrays are checked, their contents are trusted.
+ */
+template <typename Graph>
+class graph_db {
+public:
+    using VP = typename Graph::vertex_bundled_type;
+    using EP = typename Graph::edge_bundled_type;
+    using GP = typename Graph::graph_bundled_type;
+
+    graph_db() = default;
+    graph_db(const graph_db&) = delete;
+    graph_db& operator=(const graph_db&) = delete;
+
+    ~graph_db()
+    {
+        close();
+    }
+
+    /// \return false if the file is not a valid database, see error()
+    bool
+    open(const std::string& path);
+
+    void
+    close();
+
+    /// views, valid until close
+    const std::vector<Graph>&
+    graphs() const
+    {
+        return _graphs;
+    }
+
+    const graph_db_labels<VP, EP>&
+    labels() const
+    {
+        return _labels;
+    }
+
+    const std::string&
+    error() const
+    {
+        return _error;
+    }
+
+private:
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+    std::vector<Graph> _graphs;
+    graph_db_labels<VP, EP> _labels;
+    std::string _error;
+
+    bool
+    fail(const std::string& what)
+    {
+        close();
+        _error = what;
+        return false;
+    }
+
+    /// n elements at offset, null if they are out of the file
+    template <typename T>
+    const T*
+    at(std::uint64_t offset, std::uint64_t n) const
+    {
+        if (offset % alignof(T) != 0 || offset > _size
+                || n > (_size - offset) / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<const T*>(_data + offset);
+    }
+
+    bool
+    read_dict(label_dict& dict, const detail::graph_db_strings& x);
+
+    template <typename T>
+    bool
+    read_array(std::vector<T>& v, const detail::graph_db_array& x);
+};
+
+template <typename Graph>
+bool
+graph_db<Graph>::open(const std::string& path)
+{
+    close();
+    _error.clear();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return fail("can not open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || std::size_t(st.st_size) < sizeof(detail::graph_db_header)) {
+        ::close(fd);
+        return fail(path + " is not a graph database");
+    }
+    void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return fail("can not map " + path);
+    _data = static_cast<const char*>(p);
+    _size = st.st_size;
+
+    const detail::graph_db_header& h = *at<detail::graph_db_header>(0, 1);
+    std::uint64_t sizes[6];
+    detail::graph_db_sizes<Graph>(sizes);
+    if (std::memcmp(h.magic, detail::graph_db_magic, sizeof(h.magic)) != 0)
+        return fail(path + " is not a graph database");
+    if (h.version != detail::graph_db_version
+            || std::memcmp(h.sizes, sizes, sizeof(sizes)) != 0)
+        return fail(path + " is written by an incompatible version");
+    if (h.file_size != _size)
+        return fail(path + " is truncated");
+
+    const auto* entries = at<detail::graph_db_entry>(h.graphs, h.num_graphs);
+    const GP* bundles = at<GP>(h.bundles, h.num_graphs);
+    if (!entries || !bundles)
+        return fail(path + " is corrupted");
+
+    _graphs.reserve(h.num_graphs);
+    for (std::uint64_t i = 0; i < h.num_graphs; ++i) {
+        const detail::graph_db_entry& x = entries[i];
+        typename Graph::arrays a;
+        a.num_vertices = x.num_vertices;
+        a.num_edges = x.num_edges;
+        a.vertex_labels = at<VP>(x.vertex_labels, x.num_vertices);
+        a.offsets = at<std::size_t>(x.offsets, x.num_vertices + 1);
+        a.edges = at<typename Graph::edge_entry>(x.edges, x.num_edges);
+        if (a.offsets)
+            a.adj = at<typename Graph::adjacency>(x.adj, a.offsets[x.num_vertices]);
+        if (!a.vertex_labels || !a.offsets || !a.adj || !a.edges)
+            return fail(path + " is corrupted");
+        _graphs.emplace_back(a, bundles[i]);
+    }
+
+    if (!read_dict(_labels.vertex_names, h.vertex_names)
+            || !read_dict(_labels.edge_names, h.edge_names)
+            || !read_array(_labels.original.vertex, h.vertex_original)
+            || !read_array(_labels.original.edge, h.edge_original))
+        return fail(path + " is corrupted");
+    return true;
+}
+
+template <typename Graph>
+void
+graph_db<Graph>::close()
+{
+    _graphs.clear();
+    _labels = graph_db_labels<VP, EP>();
+    if (_data)
+        ::munmap(const_cast<char*>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+}
+
+template <typename Graph>
+bool
+graph_db<Graph>::read_dict(label_dict& dict, const detail::graph_db_strings& x)
+{
+    const std::uint64_t* offsets = at<std::uint64_t>(x.offsets, x.count + 1);
+    if (!offsets || offsets[0] != 0)
+        return false;
+    const char* chars = at<char>(x.chars, offsets[x.count]);
+    if (!chars)
+        return false;
+    for (std::uint64_t i = 0; i < x.count; ++i) {
+        if (offsets[i] > offsets[i + 1])
+            return false;
+    }
+    dict = label_dict(std::string(chars, offsets[x.count]),
+                      std::vector<std::uint64_t>(offsets, offsets + x.count + 1));
+    return true;
+}
+
+template <typename Graph>
+template <typename T>
+bool
+graph_db<Graph>::read_array(std::vector<T>& v, const detail::graph_db_array& x)
+{
+    const T* p = at<T>(x.offset, x.count);
+    if (!p)
+        return false;
+    v.assign(p, p + x.count);
+    return true;
+}
+
+} // namespace gspan
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * \file
+ *
+ * \brief
+ * Dense ids of the input graphs, and maps keyed by input graph
+ */
+#ifndef GSPAN_GRAPH_MAP_HPP
+#define GSPAN_GRAPH_MAP_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Ids 0, 1, ... of the input graphs, in input order.
+ *
+ * Graphs of a contiguous store, e.g. a vector, are identified by their
+ * offset from the first one. Graphs of other containers are found by
+ * binary search over their addresses.
+ */
+template <typename IG>
+class graph_ids {
+public:
+    graph_ids()
+        : _base(nullptr), _size(0), _contiguous(true)
+    {
+    }
+
+    template <typename IGIter>
+    void
+    assign(IGIter ig_begin, IGIter ig_end);
+
+    std::size_t
+    size() const
+    {
+        return _size;
+    }
+
+    /// g must be one of the assigned graphs
+    std::size_t
+    id(const IG* g) const
+    {
+        if (_contiguous) {
+            BOOST_ASSERT(std::less_equal<const IG*>()(_base, g)
+                         && std::less<const IG*>()(g, _base + _size));
+            return g - _base;
+        }
+        auto it = std::lower_bound(_sorted.begin(), _sorted.end(), g,
+        [](const std::pair<const IG*, std::size_t>& x, const IG* k) {
+            return std::less<const IG*>()(x.first, k);
+        });
+        BOOST_ASSERT(it != _sorted.end() && it->first == g);
+        return it->second;
+    }
+
+private:
+    const IG* _base;
+    std::size_t _size;
+    bool _contiguous;
+
+    /// graphs with their ids, by address; empty for a contiguous store
+    std::vector<std::pair<const IG*, std::size_t>> _sorted;
+};
+
+template <typename IG>
+template <typename IGIter>
+void
+graph_ids<IG>::assign(IGIter ig_begin, IGIter ig_end)
+{
+    _base = nullptr;
+    _size = 0;
+    _contiguous = true;
+    _sorted.clear();
+    for (IGIter g = ig_begin; g != ig_end; ++g) {
+        const IG* p = &*g;
+        if (_size == 0)
+            _base = p;
+        _contiguous = _contiguous && p == _base + _size;
+        _sorted.emplace_back(p, _size++);
+    }
+    if (_contiguous) {
+        _sorted.clear();
+        _sorted.shrink_to_fit();
+    }
+    else {
+        std::sort(_sorted.begin(), _sorted.end(),
+        [](const std::pair<const IG*, std::size_t>& lhs,
+        const std::pair<const IG*, std::size_t>& rhs) {
+            return std::less<const IG*>()(lhs.first, rhs.first);
+        });
+    }
+}
+
+/**
+ * \brief
+ * Map of input graphs to T, a vector sorted by the address of the graph.
+ *
+ * Graphs of a contiguous store are ordered by address as by id, so the
+ * iteration is in input order and does not depend on hashing. Embeddings
+ * are built graph by graph in this order, so a new graph is usually
+ * appended; a graph out of order is inserted by rebuilding the vector.
+ * The allocator is propagated to the values, as for pmr maps.
+ */
+template <typename IG, typename T>
+class graph_map {
+public:
+    using key_type = const IG*;
+    using mapped_type = T;
+    using value_type = std::pair<const IG*, T>;
+    using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+    using const_iterator = typename std::pmr::vector<value_type>::const_iterator;
+
+    explicit
+    graph_map(const allocator_type& alloc = allocator_type())
+        : _v(alloc)
+    {
+    }
+
+    graph_map(const graph_map&) = delete;
+    graph_map&
+    operator=(const graph_map&) = delete;
+    graph_map(graph_map&& rhs) = default;
+
+    graph_map(graph_map&& rhs, const allocator_type& alloc)
+        : _v(std::move(rhs._v), alloc)
+    {
+    }
+
+    const_iterator
+    begin() const
+    {
+        return _v.begin();
+    }
+
+    const_iterator
+    end() const
+    {
+        return _v.end();
+    }
+
+    std::size_t
+    size() const
+    {
+        return _v.size();
+    }
+
+    bool
+    empty() const
+    {
+        return _v.empty();
+    }
+
+    /// value of the graph, a new one for an unknown graph
+    T&
+    operator[](const IG* g);
+
+    /// move entries of the graphs, which are not in this map, from other
+    void
+    merge(graph_map& other);
+
+private:
+    std::pmr::vector<value_type> _v;
+
+    static bool
+    less(const IG* lhs, const IG* rhs)
+    {
+        return std::less<const IG*>()(lhs, rhs);
+    }
+
+    void
+    emplace_back(std::pmr::vector<value_type>& v, const IG* g)
+    {
+        v.emplace_back(std::piecewise_construct, std::forward_as_tuple(g),
+                       std::forward_as_tuple());
+    }
+};
+
+template <typename IG, typename T>
+T&
+graph_map<IG, T>::operator[](const IG* g)
+{
+    if (_v.empty() || less(_v.back().first, g)) {
+        emplace_back(_v, g);
+        return _v.back().second;
+    }
+    auto it = std::lower_bound(_v.begin(), _v.end(), g,
+    [](const value_type& x, const IG* k) {
+        return less(x.first, k);
+    });
+    if (it->first == g)
+        return it->second;
+
+    // values are not assignable, the vector is built again
+    std::size_t pos = it - _v.begin();
+    std::pmr::vector<value_type> v(_v.get_allocator());
+    v.reserve(_v.size() + 1);
+    for (std::size_t i = 0; i < pos; ++i)
+        v.push_back(std::move(_v[i]));
+    emplace_back(v, g);
+    for (std::size_t i = pos; i < _v.size(); ++i)
+        v.push_back(std::move(_v[i]));
+    _v.swap(v);
+    return _v[pos].second;
+}
+
+template <typename IG, typename T>
+void
+graph_map<IG, T>::merge(graph_map& other)
+{
+    if (other._v.empty())
+        return;
+    if (_v.empty() || less(_v.back().first, other._v.front().first)) {
+        _v.reserve(_v.size() + other._v.size());
+        for (value_type& x : other._v)
+            _v.push_back(std::move(x));
+        other._v.clear();
+        return;
+    }
+
+    std::pmr::vector<value_type> v(_v.get_allocator());
+    std::pmr::vector<value_type> rest(other._v.get_allocator());
+    v.reserve(_v.size() + other._v.size());
+    auto i = _v.begin();
+    auto j = other._v.begin();
+    while (i != _v.end() || j != other._v.end()) {
+        if (j == other._v.end() || (i != _v.end() && less(i->first, j->first))) {
+            v.push_back(std::move(*i++));
+        }
+        else if (i == _v.end() || less(j->first, i->first)) {
+            v.push_back(std::move(*j++));
+        }
+        else {
+            v.push_back(std::move(*i++));
+            rest.push_back(std::move(*j++));
+        }
+    }
+    _v.swap(v);
+    other._v.swap(rest);
+}
+
+} // namespace gspan
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * \file
+ *
+ * \brief
+ * Bitsets of input graphs, by dense graph id
+ */
+#ifndef GSPAN_GRAPH_SET_HPP
+#define GSPAN_GRAPH_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/// The popcount loop is built for several instruction sets, the one of the
+/// CPU is chosen on load: vpopcntq on AVX-512 machines, popcnt on others
+/// which have it. The build itself does not depend on -march
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) \
+    && defined(__linux__)
+#define GSPAN_POPCOUNT_CLONES \
+    __attribute__((target_clones("arch=icelake-server", "popcnt", "default")))
+#else
+#define GSPAN_POPCOUNT_CLONES
+#endif
+
+namespace gspan {
+
+/// number of bits set in both s and t, of n words
+GSPAN_POPCOUNT_CLONES
+inline std::size_t
+popcount_and(const std::uint64_t* s, const std::uint64_t* t, std::size_t n)
+{
+    std::size_t c = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        c += __builtin_popcountll(s[i] & t[i]);
+    return c;
+}
+
+/**
+ * \brief
+ * Set of input graphs, a bitset over their dense ids.
+ *
+ * The graphs, which support a pattern, are built once per pattern and
+ * intersected with the graphs of each label triple to bound the support
+ * of the extensions. They are also given to the result, which prints the
+ * ids of the graphs from it in order.
+ */
+class graph_set {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::uint64_t>;
+
+    explicit
+    graph_set(std::size_t num_graphs = 0,
+              const allocator_type& alloc = allocator_type())
+        : _words((num_graphs + 63) / 64, 0, alloc)
+    {
+    }
+
+    void
+    insert(std::size_t gid)
+    {
+        _words[gid / 64] |= std::uint64_t(1) << (gid % 64);
+    }
+
+    /// number of graphs, which are also in the bitset t over as many graphs
+    std::size_t
+    count_common(const std::uint64_t* t) const
+    {
+        return popcount_and(_words.data(), t, _words.size());
+    }
+
+    /// call f(gid) for each graph, in order of ids
+    template <typename F>
+    void
+    for_each(F&& f) const
+    {
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            for (std::uint64_t w = _words[i]; w != 0; w &= w - 1)
+                f(i * 64 + __builtin_ctzll(w));
+        }
+    }
+
+private:
+    std::pmr::vector<std::uint64_t> _words;
+};
+
+} // namespace gspan
+
+#endif
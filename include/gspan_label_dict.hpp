@@ -0,0 +1,180 @@
+/**
+ * \file
+ *
+ * \brief
+ * Dictionary of label names
+ */
+#ifndef GSPAN_LABEL_DICT_HPP
+#define GSPAN_LABEL_DICT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Interns label names as dense labels 0, 1, ... in order of first use.
+ *
+ * Names are kept in one buffer, label l is
+ * chars()[offsets()[l]] .. chars()[offsets()[l + 1] - 1], the form in
+ * which they are stored by graph_db. Lookup is an open addressing hash
+ * table of labels with linear probing, keyed by string views of the
+ * buffer. One dictionary serves one label space, e.g. vertex labels.
+ */
+class label_dict {
+public:
+    using label_type = std::size_t;
+
+    static constexpr label_type npos = label_type(-1);
+
+    label_dict()
+        : _offsets(1, 0)
+    {
+    }
+
+    /// dictionary of the stored names, see chars() and offsets()
+    label_dict(std::string chars, std::vector<std::uint64_t> offsets)
+        : _chars(std::move(chars)), _offsets(std::move(offsets))
+    {
+        _hashes.reserve(size());
+        for (label_type l = 0; l < size(); ++l)
+            _hashes.push_back(hash(name(l)));
+        rehash(capacity_for(size()));
+    }
+
+    /// label of the name, a new one for an unknown name
+    label_type
+    intern(std::string_view s);
+
+    /// label of the name, npos for an unknown name
+    label_type
+    find(std::string_view s) const;
+
+    std::string_view
+    name(label_type l) const
+    {
+        return std::string_view(_chars.data() + _offsets[l],
+                                _offsets[l + 1] - _offsets[l]);
+    }
+
+    std::size_t
+    size() const
+    {
+        return _offsets.size() - 1;
+    }
+
+    bool
+    empty() const
+    {
+        return size() == 0;
+    }
+
+    const std::string&
+    chars() const
+    {
+        return _chars;
+    }
+
+    /// size() + 1 offsets of names in chars()
+    const std::vector<std::uint64_t>&
+    offsets() const
+    {
+        return _offsets;
+    }
+
+private:
+    std::string _chars;
+    std::vector<std::uint64_t> _offsets;
+
+    /// hash of each label
+    std::vector<std::uint64_t> _hashes;
+
+    /// label + 1 per slot, 0 for an empty one; the size is a power of two
+    std::vector<std::uint32_t> _slots;
+
+    static std::uint64_t
+    hash(std::string_view s)
+    {
+        // FNV-1a
+        std::uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    /// the table is at most half full
+    static std::size_t
+    capacity_for(std::size_t n)
+    {
+        std::size_t c = 16;
+        while (c < 2 * n)
+            c *= 2;
+        return c;
+    }
+
+    /// slot of the name, or the empty slot where it belongs
+    std::size_t
+    probe(std::string_view s, std::uint64_t h) const
+    {
+        std::size_t mask = _slots.size() - 1;
+        for (std::size_t i = h & mask; ; i = (i + 1) & mask) {
+            std::uint32_t x = _slots[i];
+            if (x == 0 || (_hashes[x - 1] == h && name(x - 1) == s))
+                return i;
+        }
+    }
+
+    void
+    rehash(std::size_t capacity)
+    {
+        _slots.assign(capacity, 0);
+        std::size_t mask = capacity - 1;
+        for (label_type l = 0; l < size(); ++l) {
+            std::size_t i = _hashes[l] & mask;
+            while (_slots[i] != 0)
+                i = (i + 1) & mask;
+            _slots[i] = std::uint32_t(l + 1);
+        }
+    }
+};
+
+inline label_dict::label_type
+label_dict::intern(std::string_view s)
+{
+    if (_slots.empty())
+        rehash(capacity_for(0));
+    std::uint64_t h = hash(s);
+    std::size_t i = probe(s, h);
+    if (_slots[i] != 0)
+        return _slots[i] - 1;
+
+    label_type l = size();
+    _chars.append(s.data(), s.size());
+    _offsets.push_back(_chars.size());
+    _hashes.push_back(h);
+    if (2 * size() > _slots.size())
+        rehash(capacity_for(size()));
+    else
+        _slots[i] = std::uint32_t(l + 1);
+    return l;
+}
+
+inline label_dict::label_type
+label_dict::find(std::string_view s) const
+{
+    if (_slots.empty())
+        return npos;
+    std::size_t i = probe(s, hash(s));
+    return _slots[i] != 0 ? _slots[i] - 1 : npos;
+}
+
+} // namespace gspan
+
+#endif
@@ -0,0 +1,317 @@
+/**
+ * \file
+ *
+ * \brief
+ * Bounded cache of the minimal DFS codes of the reported patterns
+ */
+#ifndef GSPAN_MIN_CACHE_HPP
+#define GSPAN_MIN_CACHE_HPP
+
+#include "gspan_edgecode_compare.hpp"
+#include "gspan_edgecode_tree.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Counters of a min_cache
+ */
+struct min_cache_stats {
+    /// the pattern is a code of a cached graph
+    std::atomic<std::size_t> hits{0};
+    /// no code with the fingerprint of the pattern
+    std::atomic<std::size_t> misses{0};
+    /// a code with the fingerprint, but of another graph
+    std::atomic<std::size_t> collisions{0};
+    std::atomic<std::size_t> inserts{0};
+};
+
+/// default number of cached codes
+const std::size_t min_cache_capacity = 1 << 16;
+
+/**
+ * \brief
+ * Minimal DFS codes of the reported patterns, by a fingerprint of the graph.
+ *
+ * Each DFS code is generated once, from its own prefix, so the verdicts
+ * of is_minimum() never repeat for the same code. They repeat for the same
+ * graph: every non-minimal code is a code of a graph, whose minimal code
+ * comes earlier in the DFS order and is usually reported already.
+ * A pattern with the fingerprint of a cached graph is verified exactly,
+ * by an embedding of the cached code, which covers the whole pattern.
+ *
+ * The fingerprint does not depend on the order of the edges, labels must
+ * be hashable by std::hash. The cache is direct mapped: a new code
+ * replaces the code with the same slot. Thread-safe.
+ */
+template <typename MG>
+class min_cache {
+public:
+    using VI = typename MG::vertex_index_type;
+    using EI = typename MG::edge_index_type;
+    using VP = typename MG::vertex_bundled_type;
+    using EP = typename MG::edge_bundled_type;
+    using code_edge = dfs_edge<VI, VP, EP>;
+    using code_type = std::vector<code_edge>;
+
+    enum verdict { unknown, minimal, not_minimal };
+
+    /// capacity 0 disables the cache
+    explicit
+    min_cache(std::size_t capacity = min_cache_capacity);
+
+    min_cache(const min_cache&) = delete;
+    min_cache&
+    operator=(const min_cache&) = delete;
+
+    /// verdict of is_minimum() for mg, if mg is a code of a cached graph
+    verdict
+    lookup(const MG& mg);
+
+    /// cache mg, which is minimal
+    void
+    insert(const MG& mg);
+
+    const min_cache_stats&
+    stats() const
+    {
+        return _stats;
+    }
+
+private:
+    struct slot {
+        std::uint64_t fingerprint = 0;
+        code_type code;
+    };
+
+    static constexpr std::size_t nlocks = 64;
+
+    /// refinement rounds of the fingerprint
+    static constexpr unsigned int fingerprint_rounds = 4;
+
+    std::vector<slot> _slots;
+    std::vector<std::mutex> _locks;
+    min_cache_stats _stats;
+
+    static std::uint64_t
+    mix(std::uint64_t x);
+
+    static std::uint64_t
+    fingerprint(const MG& mg);
+
+    static void
+    code_of(const MG& mg, code_type& code);
+
+    /// is there an embedding of code, which covers mg
+    static bool
+    covers(const code_type& code, const MG& mg);
+
+    struct scratch {
+        /// mg vertex by code vertex
+        std::vector<VI> vertices;
+        std::vector<char> used_vertices;
+        std::vector<char> used_edges;
+    };
+
+    static bool
+    match(const code_type& code, std::size_t i, const MG& mg, scratch& x);
+};
+
+// ==========================================================================
+// class min_cache
+
+template <typename MG>
+min_cache<MG>::min_cache(std::size_t capacity)
+    : _slots(capacity), _locks(capacity ? nlocks : 0), _stats()
+{
+}
+
+template <typename MG>
+typename min_cache<MG>::verdict
+min_cache<MG>::lookup(const MG& mg)
+{
+    if (_slots.empty())
+        return unknown;
+
+    static thread_local code_type cached;
+    const std::uint64_t fp = fingerprint(mg);
+    const std::size_t i = fp % _slots.size();
+    {
+        std::lock_guard<std::mutex> lock(_locks[i % nlocks]);
+        if (_slots[i].code.empty() || _slots[i].fingerprint != fp) {
+            ++_stats.misses;
+            return unknown;
+        }
+        cached = _slots[i].code;
+    }
+
+    if (cached.size() != num_edges(mg) || !covers(cached, mg)) {
+        ++_stats.collisions;
+        return unknown;
+    }
+    ++_stats.hits;
+
+    // the cached code is the minimal code of the graph of mg
+    static thread_local code_type tested;
+    code_of(mg, tested);
+    for (std::size_t n = 0; n < tested.size(); ++n) {
+        const code_edge& a = cached[n];
+        const code_edge& b = tested[n];
+        if (std::tie(a.src, a.dst, a.src_label, a.edge_label, a.dst_label)
+                != std::tie(b.src, b.dst, b.src_label, b.edge_label, b.dst_label))
+            return not_minimal;
+    }
+    return minimal;
+}
+
+template <typename MG>
+void
+min_cache<MG>::insert(const MG& mg)
+{
+    if (_slots.empty())
+        return;
+
+    code_type code;
+    code_of(mg, code);
+    const std::uint64_t fp = fingerprint(mg);
+    const std::size_t i = fp % _slots.size();
+    std::lock_guard<std::mutex> lock(_locks[i % nlocks]);
+    _slots[i].fingerprint = fp;
+    _slots[i].code.swap(code);
+    ++_stats.inserts;
+}
+
+/// splitmix64 finalizer, sums of mixed values do not depend on the order
+template <typename MG>
+std::uint64_t
+min_cache<MG>::mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+template <typename MG>
+std::uint64_t
+min_cache<MG>::fingerprint(const MG& mg)
+{
+    std::hash<VP> vhash;
+    std::hash<EP> ehash;
+
+    // Weisfeiler-Lehman refinement: each round adds the hashes of
+    // the neighbours to the hash of a vertex
+    static thread_local std::vector<std::uint64_t> h;
+    static thread_local std::vector<std::uint64_t> next;
+    h.resize(num_vertices(mg));
+    next.resize(num_vertices(mg));
+    for (auto v : vertices(mg))
+        h[v_index(mg, v)] = mix(vhash(v_bundle(mg, v)));
+    for (unsigned int round = 0; round < fingerprint_rounds; ++round) {
+        for (auto v : vertices(mg)) {
+            std::uint64_t around = 0;
+            for (auto e : out_edges(v, mg))
+                around += mix(h[target_index(mg, e)] + ehash(e_bundle(mg, e)));
+            next[v_index(mg, v)] = mix(h[v_index(mg, v)] + around);
+        }
+        h.swap(next);
+    }
+
+    std::uint64_t fp = mix(num_vertices(mg)) + mix(num_edges(mg));
+    for (std::uint64_t x : h)
+        fp += mix(x);
+    return fp;
+}
+
+template <typename MG>
+void
+min_cache<MG>::code_of(const MG& mg, code_type& code)
+{
+    code.resize(num_edges(mg));
+    for (auto e : edges(mg)) {
+        code[e_index(mg, e)] = code_edge{source_index(mg, e), target_index(mg, e),
+                                         source_bundle(mg, e), e_bundle(mg, e),
+                                         target_bundle(mg, e)};
+    }
+}
+
+template <typename MG>
+bool
+min_cache<MG>::covers(const code_type& code, const MG& mg)
+{
+    VI nvertices = 0;
+    for (const code_edge& c : code)
+        nvertices = std::max(nvertices, VI(c.dst + 1));
+    if (nvertices != num_vertices(mg))
+        return false;
+
+    static thread_local scratch x;
+    x.vertices.assign(num_vertices(mg), 0);
+    x.used_vertices.assign(num_vertices(mg), 0);
+    x.used_edges.assign(num_edges(mg), 0);
+
+    // the first vertex of the code may be any vertex with its label
+    for (auto v : vertices(mg)) {
+        if (v_bundle(mg, v) != code[0].src_label)
+            continue;
+        VI vi = v_index(mg, v);
+        x.vertices[0] = vi;
+        x.used_vertices[vi] = 1;
+        if (match(code, 0, mg, x))
+            return true;
+        x.used_vertices[vi] = 0;
+    }
+    return false;
+}
+
+template <typename MG>
+bool
+min_cache<MG>::match(const code_type& code,
+                     std::size_t i,
+                     const MG& mg,
+                     scratch& x)
+{
+    if (i == code.size())
+        return true;
+
+    const code_edge& c = code[i];
+    for (auto e : out_edges(x.vertices[c.src], mg)) {
+        EI ei = e_index(mg, e);
+        if (x.used_edges[ei] || e_bundle(mg, e) != c.edge_label)
+            continue;
+        VI v = target_index(mg, e);
+        if (c.is_forward()) {
+            if (x.used_vertices[v] || v_bundle(mg, v) != c.dst_label)
+                continue;
+            x.vertices[c.dst] = v;
+            x.used_vertices[v] = 1;
+            x.used_edges[ei] = 1;
+            if (match(code, i + 1, mg, x))
+                return true;
+            x.used_vertices[v] = 0;
+            x.used_edges[ei] = 0;
+        }
+        else {
+            if (v != x.vertices[c.dst])
+                continue;
+            x.used_edges[ei] = 1;
+            if (match(code, i + 1, mg, x))
+                return true;
+            x.used_edges[ei] = 0;
+        }
+    }
+    return false;
+}
+
+} // namespace gspan
+
+#endif
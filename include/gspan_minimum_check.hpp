@@ -11,319 +11,472 @@
 #include "gspan_types.hpp"
 #include "gspan_helpers.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace gspan {
 
+// ==========================================================================
+// class min_state
+
 /**
- * Insert into map MinExt new entry
+ * \brief
+ * Minimality check, which keeps its embeddings for the children.
+ *
+ * For every prefix of a minimal DFS code the check finds all embeddings
+ * of the prefix into the pattern itself. A child pattern adds one edge,
+ * so the embeddings of the parent stay embeddings of the child, and the
+ * minimal extension found by the parent at each level is still a candidate.
+ * The child looks only for candidates which use its new edge: embeddings
+ * of the parent extended by the new edge, and its own embeddings.
+ * Levels of a state keep only the embeddings which use the new edge,
+ * the others are in the states of the ancestors.
+ *
+ * A pattern is tested against itself, so it is small: the used edges of
+ * an embedding are a bitset of one word up to 64 edges, and the buffers
+ * of a check are per thread and reused by the next check.
+ * States of the ancestors must live while the state is used.
  */
-template <typename MinExt, typename VI, typename MG, typename SBG,
-          typename IGEdge>
-void
-add_min_edge(MinExt& min_ext,
-             VI src,
-             VI dst,
-             const MG* prev_mg,
-             IGEdge&& e,
-             const SBG* prev_sbg)
-{
-    /// first construct and insert key (Mined Graph or Ec)
-    auto it =
-        min_ext.insert(std::make_pair(make_ec(src,
-                                      dst,
-                                      prev_mg,
-                                      e,
-                                      *prev_sbg->input_graph(),
-                                      boost::vertex_bundle_t(),
-                                      boost::edge_bundle_t()),
-                                      typename MinExt::mapped_type())).first;
-
-    /// then construct and insert *subgraph*
-    if (it == min_ext.begin()) {
-        const MG& mg = it->first;
-        it->second.emplace(it->second.begin(),
-                           *edges(mg).first,
-                           e,
-                           &mg,
-                           prev_sbg);
+template <typename MG>
+class min_state {
+public:
+    using VI = typename MG::vertex_index_type;
+    using EI = typename MG::edge_index_type;
+    using VP = typename MG::vertex_bundled_type;
+    using EP = typename MG::edge_bundled_type;
+    using code_edge = dfs_edge<VI, VP, EP>;
+
+    /// embedding of a code prefix into the pattern
+    struct embedding {
+        const embedding* prev;
+        /// pattern vertices of the source and of the target of the last edge
+        VI src;
+        VI dst;
+        /// pattern edge of the last edge
+        EI edge;
+    };
+
+    /**
+     * Check mg, which extends the pattern of parent by its last edge.
+     * parent is null for a pattern of one edge, or for a pattern checked
+     * on its own, then all the embeddings are enumerated
+     */
+    min_state(const MG& mg, const min_state* parent);
+
+    min_state(const min_state&) = delete;
+    min_state&
+    operator=(const min_state&) = delete;
+
+    bool
+    is_minimum() const
+    {
+        return _minimum;
     }
 
-    /// at last, remove all other (non-minimal entries)
-    it = min_ext.begin();
-    min_ext.erase(++it, min_ext.end());
-}
+private:
+    /// right most path of a code prefix
+    struct prefix {
+        VI rmost;
+        /// code edges of the path, from the right most vertex
+        std::vector<EI> rmpath;
+        /// code edge of the path by its source vertex, nil if there is none
+        std::vector<EI> rmpath_from;
+    };
+
+    /// the new edge, as out_edges() of its ends visit it
+    struct orientation {
+        VI src;
+        VI dst;
+        EP label;
+    };
+
+    /// minimal extensions of a level with their embeddings
+    struct candidates {
+        code_edge key;
+        std::vector<embedding> list;
+
+        void
+        add(const code_edge& k, const embedding& s);
+    };
+
+    /// per thread, sized by the largest pattern checked
+    struct scratch {
+        /// pattern vertex by code vertex
+        std::vector<VI> vertices;
+        /// code vertex by pattern vertex
+        std::vector<VI> inverse;
+        /// used pattern edges, one bit per edge
+        std::vector<std::uint64_t> edges;
+
+        bool
+        has_edge(EI e) const
+        {
+            return (edges[e >> 6] >> (e & 63)) & 1;
+        }
+    };
 
-/**
- * Insert into map MinExt new entry
- */
-template <typename MinExt, typename IG, typename IGEdge>
+    static constexpr VI nil = std::numeric_limits<VI>::max();
+    static constexpr EI no_edge = std::numeric_limits<EI>::max();
+
+    const MG& _mg;
+    const min_state* _parent;
+    std::vector<code_edge> _code;
+
+    /// one orientation for a directed graph, two for an undirected one
+    std::array<orientation, 2> _new_edge;
+    std::size_t _new_edge_count;
+
+    /// embeddings by level, the level k embeds the first k + 1 code edges
+    std::vector<std::vector<embedding>> _levels;
+
+    bool _minimum;
+
+    /// all levels are found, children may be checked incrementally
+    bool _complete;
+
+    void
+    check();
+
+    void
+    first_edges(candidates& cands, bool new_edge_only) const;
+
+    void
+    make_prefix(std::size_t k, prefix& pre) const;
+
+    void
+    extend(candidates& cands, const embedding* s, const prefix& pre) const;
+
+    /// extend an embedding of the parent, it may be extended by the new edge only
+    void
+    extend_by_new_edge(candidates& cands,
+                       const embedding* s,
+                       const prefix& pre) const;
+
+    void
+    load(scratch& x, const embedding* s) const;
+
+    void
+    unload(scratch& x, const embedding* s) const;
+};
+
+template <typename MG>
 void
-add_min_edge(MinExt& min_ext, IGEdge&& e, const IG* g)
+min_state<MG>::candidates::add(const code_edge& k, const embedding& s)
 {
-    using Traits = gspan_traits<IG>;
-
-    /// first construct and insert key (Mined Graph or Ec)
-    auto it =
-        min_ext.insert(std::make_pair(make_ec(0,
-                                      1,
-                                      nullptr,
-                                      e,
-                                      *g,
-                                      boost::vertex_bundle_t(),
-                                      boost::edge_bundle_t()),
-                                      typename MinExt::mapped_type())).first;
-
-    /// then construct and insert *subgraph*
-    if (it == min_ext.begin()) {
-        const typename Traits::MG& mg = it->first;
-        it->second.emplace(it->second.begin(), *edges(mg).first, e, &mg, g);
+    if (!list.empty()) {
+        if (key < k)
+            return;
+        if (k < key)
+            list.clear();
     }
-
-    /// at last, remove all other (non-minimal entries)
-    it = min_ext.begin();
-    min_ext.erase(++it, min_ext.end());
+    key = k;
+    list.push_back(s);
 }
 
-/**
- * Collect backward edges into MinExt container
- * \param[out] min_ext    container
- * \param[in]  rmpath     sequence of edges that forms the right most path
- * \param[in]  mg         mined graph, in this context, it means minimal graph
- * \param[in]  sbgs       subgraphs of input graph
- * \param[in]  ig         input graph, in this context, it means tested graph
- */
-template <typename MinExt, typename RMPath, typename MG, typename SBG,
-          typename IG>
-void
-enumerate_min_bck(MinExt& min_ext,
-                  const RMPath& rmpath,
-                  const MG& mg,
-                  const std::list<SBG>& sbgs,
-                  const IG& ig)
+template <typename MG>
+min_state<MG>::min_state(const MG& mg, const min_state* parent)
+    : _mg(mg), _parent(parent), _code(num_edges(mg)), _new_edge(),
+      _new_edge_count(0), _levels(), _minimum(true), _complete(false)
 {
-    using MGV = typename MG::vertex_descriptor;
-    using MGE = typename MG::edge_descriptor;
-    using IGV = typename IG::vertex_descriptor;
-    using IGE = typename IG::edge_descriptor;
-
-    /**
-     * iterate over rmpath vertices, beginning with first vertex
-     * examine all backward edges: from right most vertex to rmpath vertex
-     */
-    MGV rmostv_mg = target(rmpath.front(), mg);
-    for (MGE rme_mg : boost::adaptors::reverse(rmpath)) {
-        if (!min_ext.empty())
-            break;
-        MGV rmv_mg = source(rme_mg, mg);
-        const bool vl_less_eq = target_bundle(mg, rme_mg)
-                                <= v_bundle(mg, rmostv_mg);
-
-        for (const SBG& s : sbgs) {
-            IGV rmostv_ig = get_v_ig(s, rmostv_mg);
-            IGV rmv_ig = get_v_ig(s, rmv_mg);
-            IGE rme_ig = get_e_ig(s, rme_mg);
-            // enumerate edges from rmostv_ig to rmv_ig
-            for (IGE e : out_edges(rmostv_ig, ig)) {
-                // skip already mapped edges
-                if (get_e_mg(s, e) != MGE())
-                    continue;
-                // only from from rmostv_ig to rmv_ig
-                if (target(e, ig) != rmv_ig)
-                    continue;
-                const auto& rme_val = e_bundle(ig, rme_ig);
-                const auto& e_val = e_bundle(ig, e);
-                if ((vl_less_eq && rme_val == e_val) || (rme_val < e_val)) {
-                    auto src = v_index(mg, rmostv_mg);
-                    auto dst = v_index(mg, rmv_mg);
-                    add_min_edge(min_ext, src, dst, &mg, e, &s);
-                    break;
-                }
-            }
+    // after an unfinished check of the parent all embeddings are enumerated
+    if (_parent && !_parent->_complete)
+        _parent = nullptr;
+
+    for (auto e : edges(mg)) {
+        _code[e_index(mg, e)] = code_edge{source_index(mg, e), target_index(mg, e),
+                                          source_bundle(mg, e), e_bundle(mg, e),
+                                          target_bundle(mg, e)};
+    }
+    const code_edge& last = _code.back();
+    for (VI v : {last.src, last.dst}) {
+        for (auto e : out_edges(v, mg)) {
+            if (e_index(mg, e) == _code.size() - 1)
+                _new_edge[_new_edge_count++] = orientation{v, target_index(mg, e),
+                                                           e_bundle(mg, e)};
         }
     }
+    check();
 }
 
-/**
- * Collect forward edges into MinExt container
- * \param[out] min_ext    container
- * \param[in]  rmpath     sequence of edges that forms the right most path
- * \param[in]  mg         mined graph, in this context, it means minimal graph
- * \param[in]  sbgs       subgraphs of input graph
- * \param[in]  ig         input graph, in this context, it means tested graph
- */
-template <typename MinExt, typename RMPath, typename MG, typename SBG,
-          typename IG>
+template <typename MG>
 void
-enumerate_min_fwd(MinExt& min_ext,
-                  const RMPath& rmpath,
-                  const MG& mg,
-                  const std::list<SBG>& sbgs,
-                  const IG& ig)
+min_state<MG>::check()
 {
-    using MGV = typename MG::vertex_descriptor;
-    using MGE = typename MG::edge_descriptor;
-    using IGV = typename IG::vertex_descriptor;
-    using IGE = typename IG::edge_descriptor;
-
-    const auto& vl_min = source_bundle(mg, rmpath.back());
+    static thread_local candidates cands;
+    static thread_local prefix pre;
 
-    MGV rmostv_mg = target(rmpath.front(), mg);
-    auto rmost_index = v_index(mg, rmostv_mg);
+    const std::size_t last = _code.size() - 1;
+    _levels.reserve(_code.size());
 
-    /**
-     * forward pure
-     * examine forward edges: from right most vertex
-     */
-    for (const SBG& s : sbgs) {
-        IGV u = get_v_ig(s, rmostv_mg);
-        for (IGE e : out_edges(u, ig)) {
-            IGV v = target(e, ig);
-            // skip already mapped edges and vertices
-            if (get_v_mg(s, v) != IGV())
-                continue;
-            if (vl_min > v_bundle(ig, v))
-                continue;
-            add_min_edge(min_ext, rmost_index, rmost_index + 1, &mg, e, &s);
+    for (std::size_t k = 0; k <= last; ++k) {
+        cands.list.clear();
+        if (k == 0) {
+            first_edges(cands, _parent != nullptr);
         }
-    }
-
-    /**
-     * forward rmpath
-     * iterate over rmpath vertices, beginning with right most vertex
-     * examine forward edges: from rmpath vertex
-     */
-    for (MGE rme_mg : rmpath) {
-        if (!min_ext.empty())
-            break;
-        MGV rmv_mg = source(rme_mg, mg);
-        auto rmv_index = v_index(mg, rmv_mg);
-
-        for (const SBG& s : sbgs) {
-            IGV u = get_v_ig(s, rmv_mg);
-            for (IGE e : out_edges(u, ig)) {
-                IGV v = target(e, ig);
-                if (get_v_mg(s, v) != IGV())
+        else {
+            make_prefix(k, pre);
+            for (const embedding& s : _levels[k - 1])
+                extend(cands, &s, pre);
+            for (const min_state* p = _parent; p; p = p->_parent) {
+                if (k - 1 >= p->_levels.size())
                     continue;
-                if (vl_min > v_bundle(ig, v))
-                    continue;
-                if ((target_bundle(mg, rme_mg) <= target_bundle(ig, e)
-                        && e_bundle(mg, rme_mg) == e_bundle(ig, e))
-                        || e_bundle(mg, rme_mg) < e_bundle(ig, e)) {
-                    add_min_edge(min_ext, rmv_index, rmost_index + 1, &mg, e, &s);
-                }
+                for (const embedding& s : p->_levels[k - 1])
+                    extend_by_new_edge(cands, &s, pre);
             }
         }
+
+        // the parent has found the tested edge at this level
+        const bool known = _parent && k < last;
+        const code_edge& tested = _code[k];
+        if (cands.list.empty() && !known) {
+            // nothing to extend, the rest of the code is not checked
+            return;
+        }
+        if (!cands.list.empty() && cands.key < tested) {
+            _minimum = false;
+            return;
+        }
+        if (!known && tested < cands.key) {
+            _minimum = false;
+            return;
+        }
+        if (!cands.list.empty() && !(tested < cands.key))
+            _levels.emplace_back(cands.list.begin(), cands.list.end());
+        else
+            _levels.emplace_back();
     }
+    _complete = true;
 }
 
-/**
- * Equality check of two edges
- * \param[in] e1, e2 edge to compare
- * \param[in] g1, g2 those graphs
- */
-template <typename EcGraph>
-bool
-is_equal(const typename EcGraph::edge_descriptor& e1,
-         const EcGraph& g1,
-         const typename EcGraph::edge_descriptor& e2,
-         const EcGraph& g2)
+template <typename MG>
+void
+min_state<MG>::first_edges(candidates& cands, bool new_edge_only) const
 {
-    if (source_index(g1, e1) != source_index(g2, e2))
-        return false;
-    if (target_index(g1, e1) != target_index(g2, e2))
-        return false;
-    if (source_bundle(g1, e1) != source_bundle(g2, e2))
-        return false;
-    if (target_bundle(g1, e1) != target_bundle(g2, e2))
-        return false;
-    if (e_bundle(g1, e1) != e_bundle(g2, e2))
-        return false;
-    return true;
+    const EI last = _code.size() - 1;
+    for (auto v : vertices(_mg)) {
+        for (auto e : out_edges(v, _mg)) {
+            if (new_edge_only && e_index(_mg, e) != last)
+                continue;
+            cands.add(code_edge{0, 1, source_bundle(_mg, e), e_bundle(_mg, e),
+                                target_bundle(_mg, e)},
+                      embedding{nullptr, source_index(_mg, e),
+                                target_index(_mg, e), e_index(_mg, e)});
+        }
+    }
 }
 
-/**
- * Perform minimality check
- * \param[in] tested_graph graph for testing
- */
-template <typename EcGraph>
-bool
-is_minimum(const EcGraph& tested_graph)
+template <typename MG>
+void
+min_state<MG>::make_prefix(std::size_t k, prefix& pre) const
 {
-    using Traits = gspan_traits<EcGraph>;
-
-    const typename EcGraph::edges_size_type nedges = num_edges(tested_graph);
-    typename EcGraph::edges_size_type n = 0;
-
-    using MG = typename Traits::MG;
-    using SBG = typename Traits::SBG;
-    using MGE = typename MG::edge_descriptor;
-    using IGV = typename EcGraph::vertex_descriptor;
-    using IGE = typename EcGraph::edge_descriptor;
-
-    /**
-     * tested_dfsc is a representation of the tested_graph
-     */
-    std::vector<IGE> tested_dfsc(nedges);
-
-    /**
-     * the sequence of MinExt is a newly constructed tested_graph (MG)
-     * with mappings (std::list<SBG>) to original tested_graph.
-     * MinExt is a map, but its size is 1, it contains only one *minimal* MG
-     */
-    using MinExt = std::map<MG, std::list<SBG>, gspan::edgecode_compare_dfs>;
-    std::vector<MinExt> min_exts;
-    min_exts.reserve(nedges);
-
-    min_exts.push_back(MinExt());
-    n = nedges - 1;
-
-    for (IGE e : edges(tested_graph)) {
-        tested_dfsc[n--] = e;
+    pre.rmost = 0;
+    for (std::size_t i = 0; i < k; ++i)
+        pre.rmost = std::max(pre.rmost, _code[i].dst);
+
+    // forward edges into the right most path, from the deepest one
+    pre.rmpath.clear();
+    pre.rmpath_from.assign(pre.rmost + 1, no_edge);
+    VI v = pre.rmost;
+    for (std::size_t i = k; i-- > 0 && v != 0;) {
+        if (_code[i].is_forward() && _code[i].dst == v) {
+            pre.rmpath.push_back(i);
+            pre.rmpath_from[_code[i].src] = i;
+            v = _code[i].src;
+        }
     }
+}
 
-    for (IGV v : vertices(tested_graph)) {
-        for (IGE e : out_edges(v, tested_graph)) {
-            add_min_edge(min_exts.back(), e, &tested_graph);
+template <typename MG>
+void
+min_state<MG>::extend(candidates& cands,
+                      const embedding* s,
+                      const prefix& pre) const
+{
+    static thread_local scratch x;
+    load(x, s);
+
+    const VP& vl_min = _code[0].src_label;
+    const VI rmost = pre.rmost;
+    const VI rmost_ig = x.vertices[rmost];
+    const VP& rmost_label = v_bundle(_mg, rmost);
+
+    // backward edges from the right most vertex, to the root first
+    for (auto it = pre.rmpath.rbegin(); it != pre.rmpath.rend(); ++it) {
+        const code_edge& rme = _code[*it];
+        const VI u_ig = x.vertices[rme.src];
+        const bool vl_less_eq = rme.dst_label <= rmost_label;
+        for (auto e : out_edges(rmost_ig, _mg)) {
+            EI ei = e_index(_mg, e);
+            if (x.has_edge(ei) || target_index(_mg, e) != u_ig)
+                continue;
+            const EP& el = e_bundle(_mg, e);
+            if ((vl_less_eq && rme.edge_label == el) || rme.edge_label < el) {
+                cands.add(code_edge{rmost, rme.src, source_bundle(_mg, e), el,
+                                    target_bundle(_mg, e)},
+                          embedding{s, rmost_ig, u_ig, ei});
+            }
         }
     }
 
-    for (n = 0; n < nedges; ++n) {
-
-        const typename MinExt::value_type& last = *min_exts[n].begin();
-        MGE last_edge = *edges(last.first).first;
-
-        if (!is_equal(last_edge, last.first, tested_dfsc[n], tested_graph)) {
-            return false;
+    // backward edges are less than forward ones
+    if (cands.list.empty() || cands.key.is_forward()) {
+        // forward edges from the right most vertex
+        for (auto e : out_edges(rmost_ig, _mg)) {
+            EI ei = e_index(_mg, e);
+            VI v = target_index(_mg, e);
+            if (x.inverse[v] != nil || vl_min > v_bundle(_mg, v))
+                continue;
+            cands.add(code_edge{rmost, VI(rmost + 1), source_bundle(_mg, e),
+                                e_bundle(_mg, e), v_bundle(_mg, v)},
+                      embedding{s, rmost_ig, v, ei});
         }
 
-        std::vector<MGE> rmpath;
-        rmpath.reserve(num_edges(last.first));
-        for (MGE e : rmpath_edges(last.first))
-            rmpath.push_back(e);
+        // forward edges from the right most path, from the deepest vertex
+        for (EI i : pre.rmpath) {
+            const code_edge& rme = _code[i];
+            const VI u_ig = x.vertices[rme.src];
+            for (auto e : out_edges(u_ig, _mg)) {
+                EI ei = e_index(_mg, e);
+                VI v = target_index(_mg, e);
+                if (x.inverse[v] != nil || vl_min > v_bundle(_mg, v))
+                    continue;
+                const EP& el = e_bundle(_mg, e);
+                if ((rme.dst_label <= v_bundle(_mg, v) && rme.edge_label == el)
+                        || rme.edge_label < el) {
+                    cands.add(code_edge{rme.src, VI(rmost + 1),
+                                        source_bundle(_mg, e), el, v_bundle(_mg, v)},
+                              embedding{s, u_ig, v, ei});
+                }
+            }
+        }
+    }
 
-        min_exts.push_back(MinExt());
+    unload(x, s);
+}
 
-        enumerate_min_bck(min_exts.back(),
-                          rmpath,
-                          last.first,
-                          last.second,
-                          tested_graph);
-        if (!min_exts.back().empty()) {
+template <typename MG>
+void
+min_state<MG>::extend_by_new_edge(candidates& cands,
+                                  const embedding* s,
+                                  const prefix& pre) const
+{
+    // code vertices of the ends of the new edge, nil if s does not map them
+    const code_edge& last = _code.back();
+    VI c_src = nil;
+    VI c_dst = nil;
+    std::size_t i = 0;
+    for (const embedding* p = s; p; p = p->prev)
+        ++i;
+    for (const embedding* p = s; p; p = p->prev) {
+        const code_edge& c = _code[--i];
+        if (p->src == last.src)
+            c_src = c.src;
+        else if (p->dst == last.src)
+            c_src = c.dst;
+        if (p->src == last.dst)
+            c_dst = c.src;
+        else if (p->dst == last.dst)
+            c_dst = c.dst;
+    }
+    if (c_src == nil && c_dst == nil)
+        return;
+
+    const EI ei = _code.size() - 1;
+    const VP& vl_min = _code[0].src_label;
+    const VI rmost = pre.rmost;
+    for (std::size_t n = 0; n < _new_edge_count; ++n) {
+        const orientation& o = _new_edge[n];
+        VI from = o.src == last.src ? c_src : c_dst;
+        VI to = o.src == last.src ? c_dst : c_src;
+        if (from == nil || from > rmost)
+            continue;
+        const VP& to_label = v_bundle(_mg, o.dst);
+        if (to != nil) {
+            // backward edge from the right most vertex
+            if (from != rmost || to > rmost || pre.rmpath_from[to] == no_edge)
+                continue;
+            const code_edge& rme = _code[pre.rmpath_from[to]];
+            const bool vl_less_eq = rme.dst_label <= v_bundle(_mg, rmost);
+            if ((vl_less_eq && rme.edge_label == o.label) || rme.edge_label < o.label) {
+                cands.add(code_edge{rmost, to, v_bundle(_mg, o.src), o.label, to_label},
+                          embedding{s, o.src, o.dst, ei});
+            }
             continue;
         }
 
-        enumerate_min_fwd(min_exts.back(),
-                          rmpath,
-                          last.first,
-                          last.second,
-                          tested_graph);
-        if (!min_exts.back().empty()) {
+        if (vl_min > to_label)
             continue;
+        if (from == rmost) {
+            cands.add(code_edge{rmost, VI(rmost + 1), v_bundle(_mg, o.src), o.label,
+                                to_label},
+                      embedding{s, o.src, o.dst, ei});
+        }
+        else if (pre.rmpath_from[from] != no_edge) {
+            const code_edge& rme = _code[pre.rmpath_from[from]];
+            if ((rme.dst_label <= to_label && rme.edge_label == o.label)
+                    || rme.edge_label < o.label) {
+                cands.add(code_edge{from, VI(rmost + 1), v_bundle(_mg, o.src), o.label,
+                                    to_label},
+                          embedding{s, o.src, o.dst, ei});
+            }
         }
+    }
+}
 
-        break;
+template <typename MG>
+void
+min_state<MG>::load(scratch& x, const embedding* s) const
+{
+    if (x.vertices.size() < num_vertices(_mg)) {
+        x.vertices.resize(num_vertices(_mg), nil);
+        x.inverse.resize(num_vertices(_mg), nil);
     }
+    if (x.edges.size() * 64 < _code.size())
+        x.edges.resize((_code.size() + 63) / 64, 0);
+
+    // the level of s is the number of its edges less one
+    std::size_t i = 0;
+    for (const embedding* p = s; p; p = p->prev)
+        ++i;
+    for (const embedding* p = s; p; p = p->prev) {
+        const code_edge& c = _code[--i];
+        x.vertices[c.src] = p->src;
+        x.vertices[c.dst] = p->dst;
+        x.inverse[p->src] = c.src;
+        x.inverse[p->dst] = c.dst;
+        x.edges[p->edge >> 6] |= std::uint64_t(1) << (p->edge & 63);
+    }
+}
+
+template <typename MG>
+void
+min_state<MG>::unload(scratch& x, const embedding* s) const
+{
+    std::size_t i = 0;
+    for (const embedding* p = s; p; p = p->prev)
+        ++i;
+    for (const embedding* p = s; p; p = p->prev) {
+        const code_edge& c = _code[--i];
+        x.vertices[c.src] = nil;
+        x.vertices[c.dst] = nil;
+        x.inverse[p->src] = nil;
+        x.inverse[p->dst] = nil;
+        x.edges[p->edge >> 6] &= ~(std::uint64_t(1) << (p->edge & 63));
+    }
+}
 
-    return true;
+/**
+ * Perform minimality check
+ * \param[in] tested_graph graph for testing
+ */
+template <typename EcGraph>
+bool
+is_minimum(const EcGraph& tested_graph)
+{
+    return min_state<EcGraph>(tested_graph, nullptr).is_minimum();
 }
 
 } // namespace gspan
@@ -0,0 +1,217 @@
+/**
+ * \file
+ *
+ * \brief
+ * Output of mined patterns, written by a background thread
+ */
+#ifndef GSPAN_OUTPUT_WRITER_HPP
+#define GSPAN_OUTPUT_WRITER_HPP
+
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Appends text to a string, as an ostream would print it.
+ * Integers are formatted by to_chars; nothing is flushed
+ */
+class text_buffer {
+public:
+    explicit
+    text_buffer(std::string& s)
+        : _s(s)
+    {
+    }
+
+    text_buffer&
+    operator<<(char c)
+    {
+        _s.push_back(c);
+        return *this;
+    }
+
+    text_buffer&
+    operator<<(std::string_view s)
+    {
+        _s.append(s.data(), s.size());
+        return *this;
+    }
+
+    text_buffer&
+    operator<<(const char* s)
+    {
+        return *this << std::string_view(s);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, text_buffer&>::type
+    operator<<(T n)
+    {
+        char buf[24];
+        auto r = std::to_chars(buf, buf + sizeof(buf), n);
+        _s.append(buf, r.ptr);
+        return *this;
+    }
+
+private:
+    std::string& _s;
+};
+
+/**
+ * \brief
+ * Double-buffered output with a writer thread.
+ *
+ * Patterns are formatted into buffer() by the mining thread which reports
+ * them. A buffer of at least buffer_size bytes is handed to the writer
+ * thread on commit(), which writes it with one call while the next one
+ * is filled; written buffers are reused. Mining waits for the writer only
+ * when max_queued buffers are waiting. buffer() and commit() must not be
+ * called concurrently, as the results of gspan are not.
+ */
+class output_writer {
+public:
+    explicit
+    output_writer(std::ostream& os, std::size_t buffer_size = 1 << 20,
+                  std::size_t max_queued = 4);
+
+    output_writer(const output_writer&) = delete;
+    output_writer&
+    operator=(const output_writer&) = delete;
+
+    ~output_writer()
+    {
+        close();
+    }
+
+    /// text of the current pattern is appended here
+    std::string&
+    buffer()
+    {
+        return _current;
+    }
+
+    /// end of a pattern: a full buffer is handed to the writer
+    void
+    commit()
+    {
+        if (_current.size() >= _buffer_size)
+            queue_current();
+    }
+
+    /// write the rest, stop the writer and flush the stream
+    void
+    close();
+
+private:
+    std::ostream& _os;
+    std::size_t _buffer_size;
+    std::size_t _max_queued;
+    std::string _current;
+
+    std::mutex _mutex;
+
+    /// the writer waits for a buffer or for close
+    std::condition_variable _queued;
+
+    /// the mining thread waits for a place in the queue
+    std::condition_variable _dequeued;
+
+    std::deque<std::string> _queue;
+
+    /// written buffers, kept with their capacity
+    std::vector<std::string> _free;
+
+    bool _closed;
+    std::thread _thread;
+
+    void
+    queue_current();
+
+    void
+    run();
+};
+
+inline
+output_writer::output_writer(std::ostream& os, std::size_t buffer_size,
+                             std::size_t max_queued)
+    : _os(os), _buffer_size(buffer_size), _max_queued(max_queued),
+      _closed(false)
+{
+    _current.reserve(_buffer_size);
+    _thread = std::thread(&output_writer::run, this);
+}
+
+inline void
+output_writer::close()
+{
+    if (!_thread.joinable())
+        return;
+    if (!_current.empty())
+        queue_current();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+    }
+    _queued.notify_one();
+    _thread.join();
+    _os.flush();
+}
+
+inline void
+output_writer::queue_current()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _dequeued.wait(lock, [this]() {
+        return _queue.size() < _max_queued;
+    });
+    _queue.push_back(std::move(_current));
+    if (!_free.empty()) {
+        _current = std::move(_free.back());
+        _free.pop_back();
+    }
+    else {
+        _current = std::string();
+    }
+    lock.unlock();
+    _queued.notify_one();
+    _current.clear();
+    _current.reserve(_buffer_size);
+}
+
+inline void
+output_writer::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _queued.wait(lock, [this]() {
+            return !_queue.empty() || _closed;
+        });
+        if (_queue.empty())
+            return;
+        std::string buf = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+        _dequeued.notify_one();
+
+        _os.write(buf.data(), buf.size());
+        buf.clear();
+
+        lock.lock();
+        _free.push_back(std::move(buf));
+    }
+}
+
+} // namespace gspan
+
+#endif
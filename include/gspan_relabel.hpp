@@ -0,0 +1,188 @@
+/**
+ * \file
+ *
+ * \brief
+ * Relabeling of input graphs by label frequency
+ */
+#ifndef GSPAN_RELABEL_HPP
+#define GSPAN_RELABEL_HPP
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Original labels of the relabeled graphs, indexed by the new label
+ */
+template <typename VP, typename EP>
+struct label_table {
+    std::vector<VP> vertex;
+    std::vector<EP> edge;
+
+    bool
+    empty() const
+    {
+        return vertex.empty() && edge.empty();
+    }
+
+    const VP&
+    vertex_label(std::size_t l) const
+    {
+        return vertex[l];
+    }
+
+    const EP&
+    edge_label(std::size_t l) const
+    {
+        return edge[l];
+    }
+};
+
+namespace detail {
+
+struct label_frequency {
+    std::size_t graphs = 0;
+    std::size_t count = 0;
+    std::size_t last_graph = std::size_t(-1);
+
+    void
+    add(std::size_t g)
+    {
+        ++count;
+        if (last_graph != g) {
+            last_graph = g;
+            ++graphs;
+        }
+    }
+};
+
+/// new label is the rank of the label ordered by descending frequency
+template <typename L>
+std::vector<L>
+rank_by_frequency(const std::map<L, label_frequency>& freq)
+{
+    std::vector<L> labels;
+    labels.reserve(freq.size());
+    for (const auto& f : freq)
+        labels.push_back(f.first);
+    std::stable_sort(labels.begin(), labels.end(),
+    [&freq](const L& a, const L& b) {
+        const label_frequency& fa = freq.at(a);
+        const label_frequency& fb = freq.at(b);
+        if (fa.graphs != fb.graphs)
+            return fa.graphs > fb.graphs;
+        return fa.count > fb.count;
+    });
+    return labels;
+}
+
+} // namespace detail
+
+/**
+ * Relabel vertices and edges of num_graphs graphs in descending frequency,
+ * as the original gSpan does: the most frequent label becomes 0.
+ * Frequency is the number of graphs with the label, then the number
+ * of occurrences. Then the smallest labels of the DFS lexicographic order
+ * are the most frequent ones, so rare labels come late in DFS codes and
+ * their branches are pruned early.
+ *
+ * Labels are reached by visitors: for_each_vertex_label(i, f) calls
+ * f(VP&) for each vertex label of the graph i, for_each_edge_label(i, f)
+ * calls f(EP&) for each edge label. Labels must be ordered and
+ * constructible from std::size_t.
+ *
+ * \return table to translate new labels back to the original ones
+ */
+template <typename VP, typename EP, typename VLabels, typename ELabels>
+label_table<VP, EP>
+relabel_labels_by_frequency(std::size_t num_graphs,
+                            VLabels for_each_vertex_label,
+                            ELabels for_each_edge_label)
+{
+    std::map<VP, detail::label_frequency> vfreq;
+    std::map<EP, detail::label_frequency> efreq;
+    for (std::size_t i = 0; i < num_graphs; ++i) {
+        for_each_vertex_label(i, [&](VP& l) {
+            vfreq[l].add(i);
+        });
+        for_each_edge_label(i, [&](EP& l) {
+            efreq[l].add(i);
+        });
+    }
+
+    label_table<VP, EP> table;
+    table.vertex = detail::rank_by_frequency(vfreq);
+    table.edge = detail::rank_by_frequency(efreq);
+
+    std::map<VP, VP> vrank;
+    for (std::size_t i = 0; i < table.vertex.size(); ++i)
+        vrank.emplace(table.vertex[i], VP(i));
+    std::map<EP, EP> erank;
+    for (std::size_t i = 0; i < table.edge.size(); ++i)
+        erank.emplace(table.edge[i], EP(i));
+
+    for (std::size_t i = 0; i < num_graphs; ++i) {
+        for_each_vertex_label(i, [&](VP& l) {
+            l = vrank[l];
+        });
+        for_each_edge_label(i, [&](EP& l) {
+            l = erank[l];
+        });
+    }
+
+    return table;
+}
+
+/**
+ * Relabel input graphs in descending frequency, see
+ * relabel_labels_by_frequency(). Property maps of VPTag and EPTag
+ * must be writable.
+ *
+ * \return table to translate new labels back to the original ones
+ */
+template <typename IGIter, typename VPTag, typename EPTag>
+auto
+relabel_by_frequency(IGIter ig_begin, IGIter ig_end, VPTag vptag,
+                     EPTag eptag)
+{
+    using IG = typename std::iterator_traits<IGIter>::value_type;
+    using VPMap = typename boost::property_map<IG, VPTag>::type;
+    using EPMap = typename boost::property_map<IG, EPTag>::type;
+    using VP = typename boost::property_traits<VPMap>::value_type;
+    using EP = typename boost::property_traits<EPMap>::value_type;
+
+    std::vector<IG*> graphs;
+    for (IGIter g = ig_begin; g != ig_end; ++g)
+        graphs.push_back(&*g);
+
+    return relabel_labels_by_frequency<VP, EP>(graphs.size(),
+    [&](std::size_t i, auto f) {
+        VPMap vpmap = get(vptag, *graphs[i]);
+        for (auto v : vertices(*graphs[i])) {
+            VP l = get(vpmap, v);
+            f(l);
+            put(vpmap, v, l);
+        }
+    },
+    [&](std::size_t i, auto f) {
+        EPMap epmap = get(eptag, *graphs[i]);
+        for (auto e : edges(*graphs[i])) {
+            EP l = get(epmap, e);
+            f(l);
+            put(epmap, e, l);
+        }
+    });
+}
+
+} // namespace gspan
+
+#endif
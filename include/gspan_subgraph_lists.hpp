@@ -2,15 +2,42 @@
 #define GSPAN_SUBGRAPH_LISTS_HPP
 
 #include <list>
+#include <memory_resource>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace gspan {
 
-template <typename S>
+/// support is the number of automorphism groups of the single input graph
+struct one_graph_tag {
+};
+
+/// support is the number of input graphs
+struct many_graphs_tag {
+};
+
+/**
+ * \brief
+ * Subgraphs of one input graph, grouped by automorphism.
+ *
+ * With one_graph_tag the groups are the support, so they are built
+ * on insertion. With many_graphs_tag the groups are only output,
+ * so they are built on the first call of aut_groups().
+ */
+template <typename S, typename SupportTag = one_graph_tag>
 class subgraph_lists {
 public:
-    subgraph_lists()
-        : aut_list_size(0)
+    using group_type = std::pmr::vector<const S*>;
+    using group_list = std::pmr::list<group_type>;
+
+    /// subgraphs and groups are allocated by the allocator of the container
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    explicit
+    subgraph_lists(const allocator_type& alloc = allocator_type())
+        : all_list(alloc), _aut_list(alloc), _aut_index(alloc),
+          _grouped(eager_grouping)
     {
     }
 
@@ -19,30 +46,92 @@ public:
     operator=(const subgraph_lists&) = delete;
     subgraph_lists(subgraph_lists&& rhs) = default;
 
-    std::list<S> all_list;
-    std::list<std::vector<const S*>> aut_list;
-    unsigned int aut_list_size;
+    /// in the same memory the nodes are taken over with their groups,
+    /// in the other one subgraphs are moved, so they are grouped again
+    subgraph_lists(subgraph_lists&& rhs, const allocator_type& alloc)
+        : all_list(std::move(rhs.all_list), alloc), _aut_list(alloc),
+          _aut_index(alloc), _grouped(false)
+    {
+        if (alloc == rhs._aut_list.get_allocator()) {
+            _aut_list.swap(rhs._aut_list);
+            _aut_index.swap(rhs._aut_index);
+            _grouped = rhs._grouped;
+        }
+        else if (rhs._grouped) {
+            aut_groups();
+        }
+    }
+
+    std::pmr::list<S> all_list;
 
     template <class ... Args>
     void
     insert(Args&& ... args);
+
+    /// automorphism groups, in order of insertion of their first subgraphs.
+    /// Lazy grouping modifies the object, it must not be called concurrently
+    const group_list&
+    aut_groups() const;
+
+    unsigned int
+    aut_groups_size() const
+    {
+        return aut_groups().size();
+    }
+
+private:
+    static constexpr bool eager_grouping =
+        std::is_same<SupportTag, one_graph_tag>::value;
+
+    mutable group_list _aut_list;
+
+    /// automorphism groups by edge_set_hash() of their members
+    mutable std::pmr::unordered_multimap<std::size_t, group_type*> _aut_index;
+
+    mutable bool _grouped;
+
+    void
+    group(const S* s) const;
 };
 
-template <typename S>
+template <typename S, typename SupportTag>
 template <class ... Args>
 void
-subgraph_lists<S>::insert(Args&& ... args)
+subgraph_lists<S, SupportTag>::insert(Args&& ... args)
 {
     const S* s = &*all_list.emplace(all_list.begin(), args...);
-    const auto ri_end = aut_list.rend();
-    for (auto ri = aut_list.rbegin(); ri != ri_end; ++ri) {
-        if (is_automorphic(s, *ri->begin())) {
-            ri->push_back(s);
+    if (_grouped)
+        group(s);
+}
+
+template <typename S, typename SupportTag>
+const typename subgraph_lists<S, SupportTag>::group_list&
+subgraph_lists<S, SupportTag>::aut_groups() const
+{
+    if (!_grouped) {
+        // all_list is in reverse order of insertion
+        for (auto ri = all_list.rbegin(); ri != all_list.rend(); ++ri)
+            group(&*ri);
+        _grouped = true;
+    }
+    return _aut_list;
+}
+
+template <typename S, typename SupportTag>
+void
+subgraph_lists<S, SupportTag>::group(const S* s) const
+{
+    const std::size_t h = edge_set_hash(s);
+    auto range = _aut_index.equal_range(h);
+    for (auto i = range.first; i != range.second; ++i) {
+        group_type& grp = *i->second;
+        if (is_automorphic(s, grp.front())) {
+            grp.push_back(s);
             return;
         }
     }
-    aut_list.push_back(std::vector<const S*>({s}));
-    ++aut_list_size;
+    _aut_list.emplace_back(1, s);
+    _aut_index.emplace(h, &_aut_list.back());
 }
 
 } // namespace gspan
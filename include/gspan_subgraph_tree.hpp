@@ -14,6 +14,8 @@
 
 #include <boost/assert.hpp>
 
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 #include <limits>
 
@@ -22,7 +24,12 @@ namespace gspan {
 /**
  * \brief
  * Subgraphs, mappings between Mined and Input graphs
- * based on single-linked list
+ * based on single-linked list.
+ *
+ * Only mappings from Mined graph to Input graph are stored,
+ * so the size of a subgraph is O(size of Mined graph).
+ * Mappings from Input graph to Mined graph are found by search,
+ * or by subgraph_index, which is loaded for one subgraph at a time.
  */
 template <typename IG, typename MG>
 class subgraph_tree {
@@ -32,15 +39,30 @@ public:
     typedef boost::graph_traits<InputGraph> IGT;
     typedef boost::graph_traits<MinedGraph> MGT;
 
+    /// mappings are allocated by the allocator of the container
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
     subgraph_tree(const typename MGT::edge_descriptor& mined_edge,
                   const typename IGT::edge_descriptor& input_edge,
                   const MinedGraph* mined_graph,
-                  const InputGraph* input_graph);
+                  const InputGraph* input_graph,
+                  const allocator_type& alloc = allocator_type());
 
     subgraph_tree(const typename MGT::edge_descriptor& mined_edge,
                   const typename IGT::edge_descriptor& input_edge,
                   const MinedGraph* mined_graph,
-                  const subgraph_tree* prev);
+                  const subgraph_tree* prev,
+                  const allocator_type& alloc = allocator_type());
+
+    subgraph_tree(subgraph_tree&& rhs) = default;
+
+    subgraph_tree(subgraph_tree&& rhs, const allocator_type& alloc)
+        : _prev(rhs._prev), _mg(rhs._mg), _ig(rhs._ig), _mg_edge(rhs._mg_edge),
+          _ig_edge(rhs._ig_edge), _ig_vertices(std::move(rhs._ig_vertices), alloc),
+          _ig_edges(std::move(rhs._ig_edges), alloc),
+          _edge_set_hash(rhs._edge_set_hash)
+    {
+    }
 
     const InputGraph*
     input_graph() const
@@ -48,9 +70,36 @@ public:
         return _ig;
     }
 
+    const subgraph_tree*
+    prev() const
+    {
+        return _prev;
+    }
+
+    /// the last mapped edge
+    ///@{
+    const typename MGT::edge_descriptor&
+    mined_edge() const
+    {
+        return _mg_edge;
+    }
+
+    const typename IGT::edge_descriptor&
+    input_edge() const
+    {
+        return _ig_edge;
+    }
+
+    const MinedGraph*
+    mined_graph() const
+    {
+        return _mg;
+    }
+    ///@}
+
     /// @name map Mined graph vertex to Input graph vertex
     ///@{
-    using InputGraphVerts = std::vector<typename IGT::vertex_descriptor>;
+    using InputGraphVerts = std::pmr::vector<typename IGT::vertex_descriptor>;
     using InputGraphVertsIter = typename InputGraphVerts::const_iterator;
     using MinedGraphVertIdMap = typename
                                 boost::property_map<MinedGraph, boost::vertex_index_t>::const_type;
@@ -59,11 +108,17 @@ public:
 
     Mined2InputVertMap
     m2i_vert_map() const;
+
+    const InputGraphVerts&
+    input_vertices() const
+    {
+        return _ig_vertices;
+    }
     ///@}
 
     /// @name map Mined graph edge to Input graph edge
     ///@{
-    using InputGraphEdges = std::vector<typename IGT::edge_descriptor>;
+    using InputGraphEdges = std::pmr::vector<typename IGT::edge_descriptor>;
     using InputGraphEdgesIter = typename InputGraphEdges::const_iterator;
     using MinedGraphEdgeIdMap = typename
                                 boost::property_map<MinedGraph, boost::edge_index_t>::const_type;
@@ -72,29 +127,78 @@ public:
 
     Mined2InputEdgeMap
     m2i_edge_map() const;
+
+    const InputGraphEdges&
+    input_edges() const
+    {
+        return _ig_edges;
+    }
     ///@}
 
-    /// @name map Input graph vertex to Mined graph vertex
-    ///@{
-    using MinedGraphVerts = std::vector<typename MGT::vertex_descriptor>;
-    using MinedGraphVertsIter = typename MinedGraphVerts::const_iterator;
     using InputGraphVertIdMap = typename
                                 boost::property_map<InputGraph, boost::vertex_index_t>::const_type;
-    using Input2MinedVertMap =
-        boost::iterator_property_map<MinedGraphVertsIter, InputGraphVertIdMap>;
+    using InputGraphEdgeIdMap = typename
+                                boost::property_map<InputGraph, boost::edge_index_t>::const_type;
+
+    /// @name map Input graph vertex to Mined graph vertex
+    /// linear search, O(num_vertices(MinedGraph))
+    ///@{
+    class Input2MinedVertMap {
+    public:
+        typedef typename IGT::vertex_descriptor key_type;
+        typedef typename MGT::vertex_descriptor value_type;
+        typedef value_type reference;
+        typedef boost::readable_property_map_tag category;
+
+        explicit
+        Input2MinedVertMap(const subgraph_tree* s)
+            : _s(s)
+        {
+        }
+
+        value_type
+        operator[](const key_type& v) const;
+
+        friend value_type
+        get(const Input2MinedVertMap& pmap, const key_type& v)
+        {
+            return pmap[v];
+        }
+    private:
+        const subgraph_tree* _s;
+    };
 
     Input2MinedVertMap
     i2m_vert_map() const;
     ///@}
 
     /// @name map Input graph edge to Mined graph edge
+    /// linear search, O(num_edges(MinedGraph))
     ///@{
-    using MinedGraphEdges = std::vector<typename MGT::edge_descriptor>;
-    using MinedGraphEdgesIter = typename MinedGraphEdges::const_iterator;
-    using InputGraphEdgeIdMap = typename
-                                boost::property_map<InputGraph, boost::edge_index_t>::const_type;
-    using Input2MinedEdgeMap =
-        boost::iterator_property_map<MinedGraphEdgesIter, InputGraphEdgeIdMap>;
+    class Input2MinedEdgeMap {
+    public:
+        typedef typename IGT::edge_descriptor key_type;
+        typedef typename MGT::edge_descriptor value_type;
+        typedef value_type reference;
+        typedef boost::readable_property_map_tag category;
+
+        explicit
+        Input2MinedEdgeMap(const subgraph_tree* s)
+            : _s(s)
+        {
+        }
+
+        value_type
+        operator[](const key_type& e) const;
+
+        friend value_type
+        get(const Input2MinedEdgeMap& pmap, const key_type& e)
+        {
+            return pmap[e];
+        }
+    private:
+        const subgraph_tree* _s;
+    };
 
     Input2MinedEdgeMap
     i2m_edge_map() const;
@@ -105,6 +209,14 @@ public:
     static bool
     is_automorphic(const subgraph_tree& lhs, const subgraph_tree& rhs);
 
+    /// fingerprint of the set of edges, independent of the edges order:
+    /// automorphic subgraphs have the same value
+    std::size_t
+    edge_set_hash() const
+    {
+        return _edge_set_hash;
+    }
+
 private:
     const subgraph_tree* _prev;
 
@@ -124,23 +236,94 @@ private:
     /// values are InputGraph edge_descriptor
     InputGraphEdges _ig_edges;
 
-    /// size == num_vertices(InputGraph)
-    /// indexed by InputGraph vertex_index
-    /// values are MinedGraph vertex_descriptor
-    MinedGraphVerts _mg_vertices;
+    /// sum of mixed InputGraph edge indices
+    std::size_t _edge_set_hash;
 
-    /// size == num_edges(InputGraph)
-    /// indexed by InputGraph edge_index
-    /// values are MinedGraph edge_descriptor
-    MinedGraphEdges _mg_edges;
+    static std::size_t
+    mix(std::uint64_t x);
+};
+
+/**
+ * \brief
+ * Mappings from Input graph to Mined graph of one subgraph:
+ * Mined graph vertex of Input graph vertex, and is Input graph edge mapped.
+ *
+ * Arrays are sized by the Input graph, but they are allocated once
+ * and reused: load() and clear() touch only entries of the subgraph.
+ * Intended to be a per-thread scratch space.
+ */
+template <typename SBG>
+class subgraph_index {
+public:
+    using IG = typename SBG::InputGraph;
+    using MG = typename SBG::MinedGraph;
+    using IGV = typename boost::graph_traits<IG>::vertex_descriptor;
+    using IGE = typename boost::graph_traits<IG>::edge_descriptor;
+    using MGV = typename boost::graph_traits<MG>::vertex_descriptor;
+    using MGE = typename boost::graph_traits<MG>::edge_descriptor;
+
+    subgraph_index()
+        : _s(nullptr)
+    {
+    }
+
+    subgraph_index(const subgraph_index&) = delete;
+    subgraph_index&
+    operator=(const subgraph_index&) = delete;
+
+    void
+    load(const SBG& s);
+
+    void
+    clear();
+
+    MGV
+    vertex(const IGV& v) const
+    {
+        return _mg_vertices[get(boost::vertex_index_t(), *_s->input_graph(), v)];
+    }
+
+    bool
+    has_edge(const IGE& e) const
+    {
+        return _edge_flags[get(boost::edge_index_t(), *_s->input_graph(), e)];
+    }
+
+private:
+    const SBG* _s;
+
+    /// indexed by InputGraph vertex_index
+    std::vector<MGV> _mg_vertices;
 
-    /// size == num_edges(InputGraph)
     /// indexed by InputGraph edge_index
-    /// values: true edge exists in MG
-    ///         false edge is free
     std::vector<char> _edge_flags;
 };
 
+/**
+ * \brief
+ * Keeps a subgraph loaded into subgraph_index during the scope
+ */
+template <typename SBG>
+class subgraph_index_scope {
+public:
+    subgraph_index_scope(subgraph_index<SBG>& index, const SBG& s)
+        : _index(index)
+    {
+        _index.load(s);
+    }
+
+    subgraph_index_scope(const subgraph_index_scope&) = delete;
+    subgraph_index_scope&
+    operator=(const subgraph_index_scope&) = delete;
+
+    ~subgraph_index_scope()
+    {
+        _index.clear();
+    }
+private:
+    subgraph_index<SBG>& _index;
+};
+
 //
 // the first edge
 //
@@ -149,14 +332,13 @@ subgraph_tree<IG, MG>::subgraph_tree(const typename MGT::edge_descriptor&
                                      mined_edge,
                                      const typename IGT::edge_descriptor& input_edge,
                                      const MinedGraph* mined_graph,
-                                     const InputGraph* input_graph)
+                                     const InputGraph* input_graph,
+                                     const allocator_type& alloc)
     : _prev(nullptr), _mg(mined_graph), _ig(input_graph), _mg_edge(mined_edge),
-      _ig_edge(input_edge), _ig_vertices(), _ig_edges(), _mg_vertices(),
-      _mg_edges(), _edge_flags()
+      _ig_edge(input_edge), _ig_vertices(alloc), _ig_edges(alloc),
+      _edge_set_hash()
 {
     MinedGraphVertIdMap mvi = get(boost::vertex_index_t(), *_mg);
-    InputGraphVertIdMap ivi = get(boost::vertex_index_t(), *_ig);
-    InputGraphEdgeIdMap iei = get(boost::edge_index_t(), *_ig);
 
     // map Mined graph vertex to Input graph vertex
     _ig_vertices.resize(2);
@@ -166,18 +348,7 @@ subgraph_tree<IG, MG>::subgraph_tree(const typename MGT::edge_descriptor&
     // map Mined graph edge to Input graph edge
     _ig_edges.push_back(_ig_edge);
 
-    // map Input graph vertex to Mined graph vertex
-    _mg_vertices.resize(num_vertices(*_ig), InputGraph::null_vertex());
-    _mg_vertices[get(ivi, source(_ig_edge, *_ig))] = source(_mg_edge, *_mg);
-    _mg_vertices[get(ivi, target(_ig_edge, *_ig))] = target(_mg_edge, *_mg);
-
-    // map Input graph edge to Mined graph edge
-    _mg_edges.resize(num_edges(
-                         *_ig)); // value is default constructed MinedGraph::edge_descriptor
-    _mg_edges[get(iei, _ig_edge)] = _mg_edge;
-
-    _edge_flags.resize(num_edges(*_ig));
-    _edge_flags[get(iei, _ig_edge)] = true;
+    _edge_set_hash = mix(get(boost::edge_index_t(), *_ig, _ig_edge));
 }
 
 //
@@ -188,35 +359,42 @@ subgraph_tree<IG, MG>::subgraph_tree(const typename MGT::edge_descriptor&
                                      mined_edge,
                                      const typename IGT::edge_descriptor& input_edge,
                                      const MinedGraph* mined_graph,
-                                     const subgraph_tree* prev)
+                                     const subgraph_tree* prev,
+                                     const allocator_type& alloc)
     : _prev(prev), _mg(mined_graph), _ig(prev->_ig), _mg_edge(mined_edge),
-      _ig_edge(input_edge), _ig_vertices(prev->_ig_vertices),
-      _ig_edges(prev->_ig_edges), _mg_vertices(prev->_mg_vertices),
-      _mg_edges(prev->_mg_edges), _edge_flags(prev->_edge_flags)
+      _ig_edge(input_edge), _ig_vertices(alloc), _ig_edges(alloc),
+      _edge_set_hash()
 {
     MinedGraphVertIdMap mvi = get(boost::vertex_index_t(), *_mg);
-    InputGraphVertIdMap ivi = get(boost::vertex_index_t(), *_ig);
-    InputGraphEdgeIdMap iei = get(boost::edge_index_t(), *_ig);
 
-    BOOST_ASSERT(get(mvi, target(_mg_edge, *_mg)) <= _ig_vertices.size());
+    BOOST_ASSERT(get(mvi, target(_mg_edge, *_mg)) <= prev->_ig_vertices.size());
 
     // map Mined graph vertex to Input graph vertex
-    if (get(mvi, target(_mg_edge, *_mg)) == _ig_vertices.size()) {
-        _ig_vertices.resize(_ig_vertices.size() + 1);
-        _ig_vertices[get(mvi, target(_mg_edge, *_mg))] = target(_ig_edge, *_ig);
-    }
+    const bool new_vertex = get(mvi, target(_mg_edge, *_mg))
+                            == prev->_ig_vertices.size();
+    _ig_vertices.reserve(prev->_ig_vertices.size() + new_vertex);
+    _ig_vertices = prev->_ig_vertices;
+    if (new_vertex)
+        _ig_vertices.push_back(target(_ig_edge, *_ig));
 
     // map Mined graph edge to Input graph edge
+    _ig_edges.reserve(prev->_ig_edges.size() + 1);
+    _ig_edges = prev->_ig_edges;
     _ig_edges.push_back(_ig_edge);
 
-    // map Input graph vertex to Mined graph vertex
-    _mg_vertices[get(ivi, source(_ig_edge, *_ig))] = source(_mg_edge, *_mg);
-    _mg_vertices[get(ivi, target(_ig_edge, *_ig))] = target(_mg_edge, *_mg);
-
-    // map Input graph edge to Mined graph edge
-    _mg_edges[get(iei, _ig_edge)] = _mg_edge;
+    _edge_set_hash = prev->_edge_set_hash
+                     + mix(get(boost::edge_index_t(), *_ig, _ig_edge));
+}
 
-    _edge_flags[get(iei, _ig_edge)] = true;
+/// splitmix64 finalizer: the sum of mixed indices is a good set fingerprint
+template <typename IG, typename MG>
+std::size_t
+subgraph_tree<IG, MG>::mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<std::size_t>(x ^ (x >> 31));
 }
 
 template <typename IG, typename MG>
@@ -239,16 +417,39 @@ template <typename IG, typename MG>
 typename subgraph_tree<IG, MG>::Input2MinedVertMap
 subgraph_tree<IG, MG>::i2m_vert_map() const
 {
-    return Input2MinedVertMap(_mg_vertices.begin(),
-                              get(boost::vertex_index_t(), *_ig));
+    return Input2MinedVertMap(this);
 }
 
 template <typename IG, typename MG>
 typename subgraph_tree<IG, MG>::Input2MinedEdgeMap
 subgraph_tree<IG, MG>::i2m_edge_map() const
 {
-    return Input2MinedEdgeMap(_mg_edges.begin(),
-                              get(boost::edge_index_t(), *_ig));
+    return Input2MinedEdgeMap(this);
+}
+
+template <typename IG, typename MG>
+typename subgraph_tree<IG, MG>::Input2MinedVertMap::value_type
+subgraph_tree<IG, MG>::Input2MinedVertMap::operator[](const key_type& v) const
+{
+    const InputGraphVerts& verts = _s->_ig_vertices;
+    for (std::size_t i = 0; i < verts.size(); ++i) {
+        if (verts[i] == v)
+            return value_type(i);
+    }
+    return value_type();
+}
+
+template <typename IG, typename MG>
+typename subgraph_tree<IG, MG>::Input2MinedEdgeMap::value_type
+subgraph_tree<IG, MG>::Input2MinedEdgeMap::operator[](const key_type& e) const
+{
+    InputGraphEdgeIdMap iei = get(boost::edge_index_t(), *_s->_ig);
+    const auto ei = get(iei, e);
+    for (const subgraph_tree* p = _s; p; p = p->_prev) {
+        if (get(iei, p->_ig_edge) == ei)
+            return p->_mg_edge;
+    }
+    return value_type();
 }
 
 template <typename IG, typename MG>
@@ -258,8 +459,24 @@ subgraph_tree<IG, MG>::is_automorphic(const subgraph_tree& lhs,
 {
     if (lhs._ig != rhs._ig)
         return false;
-    BOOST_ASSERT(lhs._edge_flags.size() == rhs._edge_flags.size());
-    return lhs._edge_flags == rhs._edge_flags;
+    BOOST_ASSERT(lhs._ig_edges.size() == rhs._ig_edges.size());
+
+    // edges of lhs are distinct, so the sets are equal
+    // if every edge of lhs is found in rhs
+    InputGraphEdgeIdMap iei = get(boost::edge_index_t(), *lhs._ig);
+    for (const auto& l : lhs._ig_edges) {
+        const auto li = get(iei, l);
+        bool found = false;
+        for (const auto& r : rhs._ig_edges) {
+            if (get(iei, r) == li) {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+    }
+    return true;
 }
 
 template <typename IG, typename MG>
@@ -278,6 +495,53 @@ is_automorphic(const subgraph_tree<IG, MG>* lhs,
     return is_automorphic(*lhs, *rhs);
 }
 
+template <typename IG, typename MG>
+std::size_t
+edge_set_hash(const subgraph_tree<IG, MG>* s)
+{
+    return s->edge_set_hash();
+}
+
+// ==========================================================================
+// class subgraph_index
+
+template <typename SBG>
+void
+subgraph_index<SBG>::load(const SBG& s)
+{
+    BOOST_ASSERT(!_s);
+    const IG& ig = *s.input_graph();
+    if (_mg_vertices.size() < num_vertices(ig))
+        _mg_vertices.resize(num_vertices(ig), MGV());
+    if (_edge_flags.size() < num_edges(ig))
+        _edge_flags.resize(num_edges(ig), false);
+    _s = &s;
+
+    auto ivi = get(boost::vertex_index_t(), ig);
+    auto iei = get(boost::edge_index_t(), ig);
+    const auto& verts = s.input_vertices();
+    for (std::size_t i = 0; i < verts.size(); ++i)
+        _mg_vertices[get(ivi, verts[i])] = MGV(i);
+    for (const IGE& e : s.input_edges())
+        _edge_flags[get(iei, e)] = true;
+}
+
+template <typename SBG>
+void
+subgraph_index<SBG>::clear()
+{
+    if (!_s)
+        return;
+    const IG& ig = *_s->input_graph();
+    auto ivi = get(boost::vertex_index_t(), ig);
+    auto iei = get(boost::edge_index_t(), ig);
+    for (const IGV& v : _s->input_vertices())
+        _mg_vertices[get(ivi, v)] = MGV();
+    for (const IGE& e : _s->input_edges())
+        _edge_flags[get(iei, e)] = false;
+    _s = nullptr;
+}
+
 template <typename SBG, typename MGV>
 auto
 get_v_ig(const SBG& s, MGV&& v_mg)
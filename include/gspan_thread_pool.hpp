@@ -0,0 +1,343 @@
+/**
+ * \file
+ *
+ * \brief
+ * Work-stealing thread pool used for parallel mining
+ */
+#ifndef GSPAN_THREAD_POOL_HPP
+#define GSPAN_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Fixed size pool of workers.
+ * Each worker owns a deque of tasks: the owner pushes and pops at the back,
+ * idle workers steal from the front of the other deques.
+ * The thread which calls task_group::wait() is helping to execute tasks,
+ * so the pool with N workers starts N - 1 threads.
+ * Workers without tasks sleep until a task is submitted.
+ */
+class thread_pool {
+public:
+    using task_type = std::function<void()>;
+
+    explicit
+    thread_pool(unsigned int nthreads);
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool&
+    operator=(const thread_pool&) = delete;
+
+    ~thread_pool();
+
+    unsigned int
+    size() const
+    {
+        return _queues.size();
+    }
+
+    /// push task into the queue of the calling worker
+    void
+    submit(task_type task);
+
+    /// execute one pending task, own or stolen; false if there is nothing to do
+    bool
+    run_pending_task();
+
+    /// sleep until a task is queued or done() is true
+    template <typename Done>
+    void
+    wait_for_task(Done done);
+
+    /// wake the threads in wait_for_task(), to check their condition again
+    void
+    notify_all();
+
+private:
+    struct queue {
+        std::mutex mutex;
+        std::deque<task_type> tasks;
+    };
+
+    std::vector<std::unique_ptr<queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::atomic<bool> _done;
+    std::atomic<unsigned int> _next;
+
+    /// tasks in the queues; it may be negative for a moment, when a task
+    /// is taken before it is counted
+    std::atomic<long> _queued;
+
+    /// idle threads sleep on _idle; conditions are changed, or checked
+    /// after a change, under _idle_mutex, so no wakeup is lost
+    std::mutex _idle_mutex;
+    std::condition_variable _idle;
+
+    unsigned int
+    worker_index();
+
+    bool
+    pop(unsigned int i, task_type& task);
+
+    bool
+    steal(unsigned int i, task_type& task);
+
+    void
+    worker_loop(unsigned int i);
+
+    static thread_local const thread_pool* _this_pool;
+    static thread_local unsigned int _this_index;
+};
+
+/**
+ * \brief
+ * Set of tasks which are waited together.
+ * wait() does not block the worker: it executes pending tasks
+ * of the pool until all tasks of the group are finished, and sleeps
+ * while there are none. The first exception of the tasks is rethrown
+ * by wait().
+ */
+class task_group {
+public:
+    explicit
+    task_group(thread_pool& pool)
+        : _pool(pool), _pending(0)
+    {
+    }
+
+    task_group(const task_group&) = delete;
+    task_group&
+    operator=(const task_group&) = delete;
+
+    /// waits, but an exception of the tasks is dropped
+    ~task_group()
+    {
+        join();
+    }
+
+    template <typename F>
+    void
+    run(F&& f);
+
+    void
+    wait();
+
+private:
+    thread_pool& _pool;
+    std::atomic<std::size_t> _pending;
+
+    std::mutex _error_mutex;
+    std::exception_ptr _error;
+
+    /// wait for the tasks, without rethrowing their exception
+    void
+    join();
+
+    /// end of a task, with its exception if it has thrown
+    void
+    finish(std::exception_ptr error);
+};
+
+// ==========================================================================
+// class thread_pool
+
+inline thread_local const thread_pool* thread_pool::_this_pool = nullptr;
+inline thread_local unsigned int thread_pool::_this_index = 0;
+
+inline
+thread_pool::thread_pool(unsigned int nthreads)
+    : _queues(), _threads(), _done(false), _next(0), _queued(0)
+{
+    if (nthreads == 0)
+        nthreads = 1;
+    for (unsigned int i = 0; i < nthreads; ++i)
+        _queues.push_back(std::unique_ptr<queue>(new queue));
+
+    // worker 0 is a thread that waits a task_group
+    for (unsigned int i = 1; i < nthreads; ++i)
+        _threads.emplace_back(&thread_pool::worker_loop, this, i);
+}
+
+inline
+thread_pool::~thread_pool()
+{
+    _done = true;
+    notify_all();
+    for (std::thread& t : _threads)
+        t.join();
+}
+
+inline unsigned int
+thread_pool::worker_index()
+{
+    if (_this_pool == this)
+        return _this_index;
+    return _next++ % size();
+}
+
+inline void
+thread_pool::submit(task_type task)
+{
+    {
+        queue& q = *_queues[worker_index()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(std::move(task));
+    }
+    ++_queued;
+    {
+        std::lock_guard<std::mutex> lock(_idle_mutex);
+    }
+    _idle.notify_one();
+}
+
+template <typename Done>
+void
+thread_pool::wait_for_task(Done done)
+{
+    std::unique_lock<std::mutex> lock(_idle_mutex);
+    _idle.wait(lock, [this, &done]() {
+        return _queued > 0 || done();
+    });
+}
+
+inline void
+thread_pool::notify_all()
+{
+    {
+        std::lock_guard<std::mutex> lock(_idle_mutex);
+    }
+    _idle.notify_all();
+}
+
+inline bool
+thread_pool::pop(unsigned int i, task_type& task)
+{
+    queue& q = *_queues[i];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty())
+        return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    --_queued;
+    return true;
+}
+
+inline bool
+thread_pool::steal(unsigned int i, task_type& task)
+{
+    for (unsigned int n = 1; n < size(); ++n) {
+        queue& q = *_queues[(i + n) % size()];
+        std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+        if (!lock || q.tasks.empty())
+            continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        --_queued;
+        return true;
+    }
+    return false;
+}
+
+inline bool
+thread_pool::run_pending_task()
+{
+    if (_this_pool != this) {
+        // the first thread which waits is the worker 0
+        _this_pool = this;
+        _this_index = 0;
+    }
+    task_type task;
+    if (pop(_this_index, task) || steal(_this_index, task)) {
+        task();
+        return true;
+    }
+    return false;
+}
+
+inline void
+thread_pool::worker_loop(unsigned int i)
+{
+    _this_pool = this;
+    _this_index = i;
+    while (!_done) {
+        if (!run_pending_task()) {
+            wait_for_task([this]() {
+                return _done.load();
+            });
+        }
+    }
+}
+
+// ==========================================================================
+// class task_group
+
+template <typename F>
+void
+task_group::run(F&& f)
+{
+    ++_pending;
+    _pool.submit([this, f]() mutable {
+        std::exception_ptr error;
+        try {
+            f();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        finish(error);
+    });
+}
+
+inline void
+task_group::finish(std::exception_ptr error)
+{
+    if (error) {
+        std::lock_guard<std::mutex> lock(_error_mutex);
+        if (!_error)
+            _error = error;
+    }
+    // the group may be destroyed as soon as the last task is counted
+    thread_pool& pool = _pool;
+    if (--_pending == 0)
+        pool.notify_all();
+}
+
+inline void
+task_group::join()
+{
+    while (_pending != 0) {
+        if (!_pool.run_pending_task()) {
+            _pool.wait_for_task([this]() {
+                return _pending == 0;
+            });
+        }
+    }
+}
+
+inline void
+task_group::wait()
+{
+    join();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(_error_mutex);
+        std::swap(error, _error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace gspan
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * \file
+ *
+ * \brief
+ * Inverted index of edge label triples over the input graphs
+ */
+#ifndef GSPAN_TRIPLE_INDEX_HPP
+#define GSPAN_TRIPLE_INDEX_HPP
+
+#include "gspan_graph_set.hpp"
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace gspan {
+
+/**
+ * \brief
+ * Graphs of each (vertex label, edge label, vertex label) triple.
+ *
+ * Built once over the input database. A triple of an undirected edge is
+ * ordered by its vertex labels. Graphs are identified by their dense ids
+ * in input order, and the graphs of a triple are a bitset over the ids.
+ * Edges are indexed by edge_index, which must be less than num_edges, as
+ * for edge_mask.
+ */
+template <typename IG, typename VPTag, typename EPTag>
+class triple_index {
+public:
+    using VP = typename boost::property_traits <
+               typename boost::property_map<IG, VPTag>::const_type >::value_type;
+    using EP = typename boost::property_traits <
+               typename boost::property_map<IG, EPTag>::const_type >::value_type;
+    using triple_id = std::uint32_t;
+
+    template <typename IGIter>
+    triple_index(IGIter ig_begin, IGIter ig_end, VPTag vptag, EPTag eptag);
+
+    std::size_t
+    num_graphs() const
+    {
+        return _edge_triples.size();
+    }
+
+    std::size_t
+    num_triples() const
+    {
+        return _num_triples;
+    }
+
+    triple_id
+    edge_triple(std::size_t gid, std::size_t edge_index) const
+    {
+        return _edge_triples[gid][edge_index];
+    }
+
+    /// bitset of the graphs, which contain the triple
+    const std::uint64_t*
+    graphs(triple_id t) const
+    {
+        return _graphs.data() + t * _words;
+    }
+
+private:
+    std::size_t _num_triples;
+    std::size_t _words;
+
+    /// triple of each edge, by graph id and edge_index
+    std::vector<std::vector<triple_id>> _edge_triples;
+
+    /// _words words per triple
+    std::vector<std::uint64_t> _graphs;
+};
+
+template <typename IG, typename VPTag, typename EPTag>
+template <typename IGIter>
+triple_index<IG, VPTag, EPTag>::triple_index(IGIter ig_begin, IGIter ig_end,
+        VPTag vptag, EPTag eptag)
+    : _num_triples(0), _words(0)
+{
+    const bool undirected = std::is_convertible <
+                            typename boost::graph_traits<IG>::directed_category,
+                            boost::undirected_tag >::value;
+
+    std::map<std::tuple<VP, EP, VP>, triple_id> ids;
+    for (IGIter g = ig_begin; g != ig_end; ++g) {
+        std::size_t gid = _edge_triples.size();
+        _edge_triples.emplace_back(num_edges(*g));
+        for (auto e : edges(*g)) {
+            VP src = get(vptag, *g, source(e, *g));
+            VP dst = get(vptag, *g, target(e, *g));
+            if (undirected && dst < src)
+                std::swap(src, dst);
+            auto it = ids.emplace(std::make_tuple(src, get(eptag, *g, e), dst),
+                                  triple_id(ids.size())).first;
+            _edge_triples[gid][get(boost::edge_index_t(), *g, e)] = it->second;
+        }
+    }
+
+    _num_triples = ids.size();
+    _words = (_edge_triples.size() + 63) / 64;
+    _graphs.assign(_num_triples * _words, 0);
+    for (std::size_t gid = 0; gid < _edge_triples.size(); ++gid) {
+        for (triple_id t : _edge_triples[gid])
+            _graphs[t * _words + gid / 64] |= std::uint64_t(1) << (gid % 64);
+    }
+}
+
+/**
+ * \brief
+ * Upper bound of the support of the children of a pattern.
+ *
+ * A child, whose new edge has the triple t, is supported only by graphs
+ * of the pattern, which contain t. Triples are tested once per pattern,
+ * when one of their edges is met. Not thread-safe, one per worker.
+ */
+template <typename Index>
+class triple_bound {
+public:
+    /// support_set is the graphs of the pattern
+    triple_bound(const Index& index, const graph_set& support_set,
+                 std::size_t minsup)
+        : _index(index), _support_set(support_set), _minsup(minsup),
+          _state(index.num_triples(), unknown)
+    {
+    }
+
+    /// may an extension by the edge of the graph be frequent
+    bool
+    admits(std::size_t gid, std::size_t edge_index)
+    {
+        auto t = _index.edge_triple(gid, edge_index);
+        if (_state[t] == unknown)
+            _state[t] = _support_set.count_common(_index.graphs(t)) >= _minsup
+                        ? frequent : infrequent;
+        return _state[t] == frequent;
+    }
+
+private:
+    enum : char { unknown, frequent, infrequent };
+
+    const Index& _index;
+    const graph_set& _support_set;
+    std::size_t _minsup;
+    std::vector<char> _state;
+};
+
+} // namespace gspan
+
+#endif
@@ -10,6 +10,7 @@
 
 #include "gspan_edgecode_tree.hpp"
 #include "gspan_edgecode_compare.hpp"
+#include "gspan_graph_map.hpp"
 #include "gspan_subgraph_tree.hpp"
 #include "gspan_subgraph_lists.hpp"
 
@@ -18,11 +19,12 @@
 #include <boost/property_map/property_map.hpp>
 
 #include <map>
-#include <unordered_map>
+#include <memory_resource>
 #include <utility>
 
 template <typename IG_, typename VPTag = boost::vertex_bundle_t,
-          typename EPTag = boost::edge_bundle_t>
+          typename EPTag = boost::edge_bundle_t,
+          typename SupportTag = gspan::one_graph_tag>
 class gspan_traits {
     using vp_ig_pmap = typename boost::property_map<IG_, VPTag>::const_type;
     using ep_ig_pmap = typename boost::property_map<IG_, EPTag>::const_type;
@@ -49,13 +51,15 @@ public:
     /// subgraph (SBG)
     using SBG = gspan::subgraph_tree<IG, MG>;
 
-    /// subgraph (SBG) lists
-    using SBGS = gspan::subgraph_lists<SBG>;
+    /// subgraph (SBG) lists, grouped by automorphism as SupportTag requires
+    using SBGS = gspan::subgraph_lists<SBG, SupportTag>;
 
     /// Edge extentions
-    using SG = std::unordered_map<const IG*, SBGS>;
-    using RExt = std::map<MG, SG, gspan::edgecode_compare_dfs>;
-    using XExt = std::map<MG, SG, gspan::edgecode_compare_lex>;
+    /// allocators of the maps are propagated to the subgraphs.
+    /// Subgraphs of a pattern are kept in order of the input graphs
+    using SG = gspan::graph_map<IG, SBGS>;
+    using RExt = std::pmr::map<MG, SG, gspan::edgecode_compare_dfs>;
+    using XExt = std::pmr::map<MG, SG, gspan::edgecode_compare_lex>;
     //using MinExt = std::map<MG, std::list<SBG>, gspan::edgecode_compare_dfs>;
 };
 